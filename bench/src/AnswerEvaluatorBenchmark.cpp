@@ -0,0 +1,123 @@
+/**
+ * @file AnswerEvaluatorBenchmark.cpp
+ *
+ * This module contains a benchmark which compares the cost of
+ * evaluating typical answers by the fast path for short whole numbers
+ * against the cost of evaluating the same answers with the parser,
+ * and against StringExtensions::ToInteger, which was used to read
+ * answers before answers were evaluated by value.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <AnswerEvaluator.hpp>
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <StringExtensions/StringExtensions.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the answers evaluated by the benchmark, typical
+     * of what users send in response to math questions.
+     */
+    const std::vector< std::string > ANSWERS{
+        "42", "137", "7", "1000", "-5", "0", "96", "23", "358", "64",
+        "12", "250", "81", "9", "1024", "77", "3", "199", "45", "512",
+    };
+
+    /**
+     * This is the number of times each answer is evaluated
+     * in each trial.
+     */
+    constexpr size_t REPETITIONS = 50000;
+
+    /**
+     * This is the number of trials of each way of evaluating answers.
+     * The fastest trial is reported, to reduce noise.
+     */
+    constexpr size_t TRIALS = 5;
+
+    /**
+     * This is where the values of answers are accumulated,
+     * so that evaluating them can't be optimized away.
+     */
+    volatile intmax_t sink = 0;
+
+    /**
+     * This function measures the given way of evaluating answers.
+     *
+     * @param[in] evaluate
+     *     This is the function to call to evaluate an answer,
+     *     returning its value.
+     *
+     * @return
+     *     The fastest time, in nanoseconds, taken to evaluate
+     *     one answer is returned.
+     */
+    double Measure(std::function< intmax_t(const std::string& answer) > evaluate) {
+        double best = 0.0;
+        for (size_t trial = 0; trial < TRIALS; ++trial) {
+            const auto start = std::chrono::steady_clock::now();
+            intmax_t total = 0;
+            for (size_t i = 0; i < REPETITIONS; ++i) {
+                for (const auto& answer: ANSWERS) {
+                    total += evaluate(answer);
+                }
+            }
+            const auto stop = std::chrono::steady_clock::now();
+            sink = sink + total;
+            const auto nanoseconds = (
+                std::chrono::duration< double, std::nano >(stop - start).count()
+                / (double)(REPETITIONS * ANSWERS.size())
+            );
+            if (
+                (trial == 0)
+                || (nanoseconds < best)
+            ) {
+                best = nanoseconds;
+            }
+        }
+        return best;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @return
+ *     The exit code of the program is returned.  This is nonzero
+ *     if the fast path was slower than the parser.
+ */
+int main() {
+    const auto fastPath = Measure(
+        [](const std::string& answer){
+            AnswerValue value;
+            (void)EvaluateAnswer(answer, AnswerSyntax::Number, value);
+            return value.numerator;
+        }
+    );
+    const auto parser = Measure(
+        [](const std::string& answer){
+            AnswerValue value;
+            (void)EvaluateAnswerWithoutFastPath(answer, AnswerSyntax::Number, value);
+            return value.numerator;
+        }
+    );
+    const auto toInteger = Measure(
+        [](const std::string& answer){
+            intmax_t value = 0;
+            (void)StringExtensions::ToInteger(answer, value);
+            return value;
+        }
+    );
+    printf("EvaluateAnswer (fast path):     %6.1f ns per answer\n", fastPath);
+    printf("EvaluateAnswer (parser only):   %6.1f ns per answer\n", parser);
+    printf("StringExtensions::ToInteger:    %6.1f ns per answer\n", toInteger);
+    return (fastPath <= parser) ? 0 : 1;
+}
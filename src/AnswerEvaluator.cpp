@@ -0,0 +1,644 @@
+/**
+ * @file AnswerEvaluator.cpp
+ *
+ * This module contains the implementation of the AnswerValue and
+ * AnswerValueHash structures, and the functions used to evaluate
+ * the answers users give to math questions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "AnswerEvaluator.hpp"
+
+#include <limits>
+#include <StringExtensions/StringExtensions.hpp>
+#include <utility>
+
+namespace {
+
+    /**
+     * This is the largest number of digits a whole number may have
+     * and still be parsed without checking for overflow.
+     */
+    constexpr size_t MAX_UNCHECKED_DIGITS = std::numeric_limits< intmax_t >::digits10;
+
+    /**
+     * This is the largest number of nested parentheses accepted
+     * in an expression.
+     */
+    constexpr size_t MAX_NESTING_DEPTH = 16;
+
+    /**
+     * This function determines whether or not the given character
+     * is whitespace.
+     *
+     * @param[in] c
+     *     This is the character to check.
+     *
+     * @return
+     *     An indication of whether or not the character is whitespace
+     *     is returned.
+     */
+    bool IsSpace(char c) {
+        return (
+            (c == ' ')
+            || (c == '\t')
+            || (c == '\r')
+            || (c == '\n')
+        );
+    }
+
+    /**
+     * This function moves the given bounds of some text inward
+     * past any whitespace at either end.
+     *
+     * @param[in,out] begin
+     *     This points to the first character of the text.
+     *
+     * @param[in,out] end
+     *     This points just past the last character of the text.
+     */
+    void TrimSpace(
+        const char*& begin,
+        const char*& end
+    ) {
+        while ((begin != end) && IsSpace(*begin)) {
+            ++begin;
+        }
+        while ((begin != end) && IsSpace(end[-1])) {
+            --end;
+        }
+    }
+
+    /**
+     * This function determines whether or not the given character
+     * is a decimal digit.
+     *
+     * @param[in] c
+     *     This is the character to check.
+     *
+     * @return
+     *     An indication of whether or not the character is a decimal digit
+     *     is returned.
+     */
+    bool IsDigit(char c) {
+        return ((c >= '0') && (c <= '9'));
+    }
+
+    /**
+     * This function computes the greatest common divisor
+     * of two non-negative numbers.
+     *
+     * @param[in] a
+     *     This is the first number.
+     *
+     * @param[in] b
+     *     This is the second number.
+     *
+     * @return
+     *     The greatest common divisor of the two numbers is returned.
+     */
+    intmax_t GreatestCommonDivisor(intmax_t a, intmax_t b) {
+        while (b != 0) {
+            const auto remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
+
+    /**
+     * This function adds two numbers, detecting overflow.
+     *
+     * @param[in] a
+     *     This is the first number.
+     *
+     * @param[in] b
+     *     This is the second number.
+     *
+     * @param[out] result
+     *     This is where to store the sum.
+     *
+     * @return
+     *     An indication of whether or not the sum fits is returned.
+     */
+    bool CheckedAdd(intmax_t a, intmax_t b, intmax_t& result) {
+        if (
+            ((b > 0) && (a > std::numeric_limits< intmax_t >::max() - b))
+            || ((b < 0) && (a < std::numeric_limits< intmax_t >::min() - b))
+        ) {
+            return false;
+        }
+        result = a + b;
+        return true;
+    }
+
+    /**
+     * This function multiplies two numbers, detecting overflow.
+     *
+     * @param[in] a
+     *     This is the first number.
+     *
+     * @param[in] b
+     *     This is the second number.
+     *
+     * @param[out] result
+     *     This is where to store the product.
+     *
+     * @return
+     *     An indication of whether or not the product fits is returned.
+     */
+    bool CheckedMultiply(intmax_t a, intmax_t b, intmax_t& result) {
+        if ((a == 0) || (b == 0)) {
+            result = 0;
+            return true;
+        }
+        if (
+            (a == std::numeric_limits< intmax_t >::min())
+            || (b == std::numeric_limits< intmax_t >::min())
+        ) {
+            return false;
+        }
+        const auto magnitudeA = (a < 0) ? -a : a;
+        const auto magnitudeB = (b < 0) ? -b : b;
+        if (magnitudeA > std::numeric_limits< intmax_t >::max() / magnitudeB) {
+            return false;
+        }
+        result = a * b;
+        return true;
+    }
+
+    /**
+     * This function puts the given fraction into lowest terms
+     * with a positive denominator.
+     *
+     * @param[in,out] value
+     *     This is the fraction to normalize.
+     *
+     * @return
+     *     An indication of whether or not the fraction could be
+     *     normalized (its denominator is nonzero and it doesn't
+     *     overflow) is returned.
+     */
+    bool Normalize(AnswerValue& value) {
+        if (
+            (value.denominator == 0)
+            || (value.numerator == std::numeric_limits< intmax_t >::min())
+            || (value.denominator == std::numeric_limits< intmax_t >::min())
+        ) {
+            return false;
+        }
+        if (value.denominator < 0) {
+            value.numerator = -value.numerator;
+            value.denominator = -value.denominator;
+        }
+        const auto divisor = GreatestCommonDivisor(
+            (value.numerator < 0) ? -value.numerator : value.numerator,
+            value.denominator
+        );
+        if (divisor > 1) {
+            value.numerator /= divisor;
+            value.denominator /= divisor;
+        }
+        return true;
+    }
+
+    /**
+     * This function adds two fractions.
+     *
+     * @param[in] a
+     *     This is the first fraction.
+     *
+     * @param[in] b
+     *     This is the second fraction.
+     *
+     * @param[out] result
+     *     This is where to store the sum.
+     *
+     * @return
+     *     An indication of whether or not the sum could be computed
+     *     is returned.
+     */
+    bool Add(const AnswerValue& a, const AnswerValue& b, AnswerValue& result) {
+        intmax_t left, right;
+        return (
+            CheckedMultiply(a.numerator, b.denominator, left)
+            && CheckedMultiply(b.numerator, a.denominator, right)
+            && CheckedAdd(left, right, result.numerator)
+            && CheckedMultiply(a.denominator, b.denominator, result.denominator)
+            && Normalize(result)
+        );
+    }
+
+    /**
+     * This function multiplies two fractions.
+     *
+     * @param[in] a
+     *     This is the first fraction.
+     *
+     * @param[in] b
+     *     This is the second fraction.
+     *
+     * @param[out] result
+     *     This is where to store the product.
+     *
+     * @return
+     *     An indication of whether or not the product could be computed
+     *     is returned.
+     */
+    bool Multiply(const AnswerValue& a, const AnswerValue& b, AnswerValue& result) {
+        return (
+            CheckedMultiply(a.numerator, b.numerator, result.numerator)
+            && CheckedMultiply(a.denominator, b.denominator, result.denominator)
+            && Normalize(result)
+        );
+    }
+
+    /**
+     * This function negates a fraction.
+     *
+     * @param[in,out] value
+     *     This is the fraction to negate.
+     */
+    void Negate(AnswerValue& value) {
+        value.numerator = -value.numerator;
+    }
+
+    /**
+     * This function computes the reciprocal of a fraction.
+     *
+     * @param[in,out] value
+     *     This is the fraction whose reciprocal to compute.
+     *
+     * @return
+     *     An indication of whether or not the fraction has a reciprocal
+     *     (is nonzero) is returned.
+     */
+    bool Invert(AnswerValue& value) {
+        std::swap(value.numerator, value.denominator);
+        return Normalize(value);
+    }
+
+    /**
+     * This evaluates text as an answer, using recursive descent
+     * over the characters of the text.
+     */
+    struct Evaluator {
+        // Properties
+
+        /**
+         * This points to the next character to evaluate.
+         */
+        const char* next;
+
+        /**
+         * This points just past the last character to evaluate.
+         */
+        const char* end;
+
+        /**
+         * This is the number of parentheses enclosing the part
+         * of the expression being evaluated.
+         */
+        size_t depth = 0;
+
+        // Methods
+
+        /**
+         * This method skips over any whitespace.
+         */
+        void SkipSpace() {
+            while ((next != end) && IsSpace(*next)) {
+                ++next;
+            }
+        }
+
+        /**
+         * This method checks whether or not the next character
+         * is the given one, and if so, skips over it and any
+         * whitespace following it.
+         *
+         * @param[in] c
+         *     This is the character to check for.
+         *
+         * @return
+         *     An indication of whether or not the next character
+         *     was the given one is returned.
+         */
+        bool Accept(char c) {
+            if ((next == end) || (*next != c)) {
+                return false;
+            }
+            ++next;
+            SkipSpace();
+            return true;
+        }
+
+        /**
+         * This method evaluates an unsigned whole number or decimal.
+         *
+         * @param[out] value
+         *     This is where to store the value of the number.
+         *
+         * @return
+         *     An indication of whether or not a number was evaluated
+         *     is returned.
+         */
+        bool EvaluateUnsignedNumber(AnswerValue& value) {
+            if ((next == end) || !IsDigit(*next)) {
+                return false;
+            }
+            value.numerator = 0;
+            value.denominator = 1;
+            while ((next != end) && IsDigit(*next)) {
+                if (
+                    !CheckedMultiply(value.numerator, 10, value.numerator)
+                    || !CheckedAdd(value.numerator, *next - '0', value.numerator)
+                ) {
+                    return false;
+                }
+                ++next;
+            }
+            if ((next != end) && (*next == '.')) {
+                ++next;
+                if ((next == end) || !IsDigit(*next)) {
+                    return false;
+                }
+                while ((next != end) && IsDigit(*next)) {
+                    if (
+                        !CheckedMultiply(value.numerator, 10, value.numerator)
+                        || !CheckedAdd(value.numerator, *next - '0', value.numerator)
+                        || !CheckedMultiply(value.denominator, 10, value.denominator)
+                    ) {
+                        return false;
+                    }
+                    ++next;
+                }
+            }
+            SkipSpace();
+            return Normalize(value);
+        }
+
+        /**
+         * This method evaluates a single number, which may be negative,
+         * and may be a fraction.
+         *
+         * @param[out] value
+         *     This is where to store the value of the number.
+         *
+         * @return
+         *     An indication of whether or not a number was evaluated
+         *     is returned.
+         */
+        bool EvaluateNumber(AnswerValue& value) {
+            const auto negative = Accept('-');
+            if (!EvaluateUnsignedNumber(value)) {
+                return false;
+            }
+            if (Accept('/')) {
+                AnswerValue divisor;
+                if (
+                    !EvaluateUnsignedNumber(divisor)
+                    || !Invert(divisor)
+                    || !Multiply(value, divisor, value)
+                ) {
+                    return false;
+                }
+            }
+            if (negative) {
+                Negate(value);
+            }
+            return true;
+        }
+
+        /**
+         * This method evaluates a factor of an expression: a number,
+         * a negated factor, or an expression in parentheses.
+         *
+         * @param[out] value
+         *     This is where to store the value of the factor.
+         *
+         * @return
+         *     An indication of whether or not a factor was evaluated
+         *     is returned.
+         */
+        bool EvaluateFactor(AnswerValue& value) {
+            if (Accept('-')) {
+                if (!EvaluateFactor(value)) {
+                    return false;
+                }
+                Negate(value);
+                return true;
+            } else if (Accept('(')) {
+                if (++depth > MAX_NESTING_DEPTH) {
+                    return false;
+                }
+                if (
+                    !EvaluateExpression(value)
+                    || !Accept(')')
+                ) {
+                    return false;
+                }
+                --depth;
+                return true;
+            } else {
+                return EvaluateUnsignedNumber(value);
+            }
+        }
+
+        /**
+         * This method evaluates a term of an expression: one or more
+         * factors multiplied or divided together.
+         *
+         * @param[out] value
+         *     This is where to store the value of the term.
+         *
+         * @return
+         *     An indication of whether or not a term was evaluated
+         *     is returned.
+         */
+        bool EvaluateTerm(AnswerValue& value) {
+            if (!EvaluateFactor(value)) {
+                return false;
+            }
+            for (;;) {
+                AnswerValue factor;
+                if (Accept('*')) {
+                    if (
+                        !EvaluateFactor(factor)
+                        || !Multiply(value, factor, value)
+                    ) {
+                        return false;
+                    }
+                } else if (Accept('/')) {
+                    if (
+                        !EvaluateFactor(factor)
+                        || !Invert(factor)
+                        || !Multiply(value, factor, value)
+                    ) {
+                        return false;
+                    }
+                } else {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * This method evaluates an expression: one or more terms
+         * added or subtracted together.
+         *
+         * @param[out] value
+         *     This is where to store the value of the expression.
+         *
+         * @return
+         *     An indication of whether or not an expression was evaluated
+         *     is returned.
+         */
+        bool EvaluateExpression(AnswerValue& value) {
+            if (!EvaluateTerm(value)) {
+                return false;
+            }
+            for (;;) {
+                AnswerValue term;
+                if (Accept('+')) {
+                    if (
+                        !EvaluateTerm(term)
+                        || !Add(value, term, value)
+                    ) {
+                        return false;
+                    }
+                } else if (Accept('-')) {
+                    if (!EvaluateTerm(term)) {
+                        return false;
+                    }
+                    Negate(term);
+                    if (!Add(value, term, value)) {
+                        return false;
+                    }
+                } else {
+                    return true;
+                }
+            }
+        }
+    };
+
+    /**
+     * This function evaluates the given text as an answer using the
+     * parser.  It's kept apart from EvaluateAnswer so that the common
+     * case of a short whole number, which doesn't need the parser,
+     * stays cheap.
+     *
+     * @param[in] begin
+     *     This points to the first character of the text to evaluate.
+     *
+     * @param[in] end
+     *     This points just past the last character of the text to evaluate.
+     *
+     * @param[in] syntax
+     *     This indicates the kind of text which is accepted.
+     *
+     * @param[out] value
+     *     This is where to store the value of the answer.
+     *
+     * @return
+     *     An indication of whether or not the text was accepted and
+     *     evaluated is returned.
+     */
+    bool EvaluateWithParser(
+        const char* begin,
+        const char* end,
+        AnswerSyntax syntax,
+        AnswerValue& value
+    ) {
+        Evaluator evaluator;
+        evaluator.next = begin;
+        evaluator.end = end;
+        AnswerValue result;
+        if (syntax == AnswerSyntax::Number) {
+            if (!evaluator.EvaluateNumber(result)) {
+                return false;
+            }
+        } else {
+            if (!evaluator.EvaluateExpression(result)) {
+                return false;
+            }
+        }
+        if (evaluator.next != end) {
+            return false;
+        }
+        value = result;
+        return true;
+    }
+
+}
+
+bool AnswerValue::operator==(const AnswerValue& other) const {
+    return (
+        (numerator == other.numerator)
+        && (denominator == other.denominator)
+    );
+}
+
+bool AnswerValue::operator!=(const AnswerValue& other) const {
+    return !(*this == other);
+}
+
+std::string AnswerValue::ToString() const {
+    if (denominator == 1) {
+        return StringExtensions::sprintf("%jd", numerator);
+    } else {
+        return StringExtensions::sprintf("%jd/%jd", numerator, denominator);
+    }
+}
+
+size_t AnswerValueHash::operator()(const AnswerValue& value) const {
+    const auto numerator = (uintmax_t)value.numerator;
+    const auto denominator = (uintmax_t)value.denominator;
+    return (size_t)(numerator * 0x9E3779B97F4A7C15ULL ^ denominator);
+}
+
+bool EvaluateAnswer(
+    const std::string& text,
+    AnswerSyntax syntax,
+    AnswerValue& value
+) {
+    const char* begin = text.data();
+    const char* end = begin + text.length();
+    TrimSpace(begin, end);
+
+    // Fast path: a whole number short enough that it can't overflow.
+    const auto negative = ((begin != end) && (*begin == '-'));
+    const char* digits = begin + (negative ? 1 : 0);
+    const auto numDigits = (size_t)(end - digits);
+    if (
+        (numDigits > 0)
+        && (numDigits <= MAX_UNCHECKED_DIGITS)
+    ) {
+        intmax_t number = 0;
+        const char* c = digits;
+        while ((c != end) && IsDigit(*c)) {
+            number = number * 10 + (*c - '0');
+            ++c;
+        }
+        if (c == end) {
+            value.numerator = negative ? -number : number;
+            value.denominator = 1;
+            return true;
+        }
+    }
+
+    // Slow path: decimals, fractions, and expressions.
+    return EvaluateWithParser(begin, end, syntax, value);
+}
+
+bool EvaluateAnswerWithoutFastPath(
+    const std::string& text,
+    AnswerSyntax syntax,
+    AnswerValue& value
+) {
+    const char* begin = text.data();
+    const char* end = begin + text.length();
+    TrimSpace(begin, end);
+    return EvaluateWithParser(begin, end, syntax, value);
+}
@@ -0,0 +1,157 @@
+#ifndef ANSWER_EVALUATOR_HPP
+#define ANSWER_EVALUATOR_HPP
+
+/**
+ * @file AnswerEvaluator.hpp
+ *
+ * This module declares the AnswerValue and AnswerValueHash structures,
+ * and the functions used to evaluate the answers users give
+ * to math questions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * This is the canonical value of an answer: a fraction in lowest terms
+ * with a positive denominator.  Whole numbers have a denominator of 1.
+ */
+struct AnswerValue {
+    // Properties
+
+    /**
+     * This is the numerator of the fraction.
+     */
+    intmax_t numerator = 0;
+
+    /**
+     * This is the denominator of the fraction.
+     */
+    intmax_t denominator = 1;
+
+    // Methods
+
+    /**
+     * This is the equality comparison operator.
+     *
+     * @param[in] other
+     *     This is the other value to which to compare this value.
+     *
+     * @return
+     *     An indication of whether or not the two values are equal
+     *     is returned.
+     */
+    bool operator==(const AnswerValue& other) const;
+
+    /**
+     * This is the inequality comparison operator.
+     *
+     * @param[in] other
+     *     This is the other value to which to compare this value.
+     *
+     * @return
+     *     An indication of whether or not the two values are different
+     *     is returned.
+     */
+    bool operator!=(const AnswerValue& other) const;
+
+    /**
+     * This method renders the value as text, either as a whole number
+     * or as a fraction (numerator, slash, denominator).
+     *
+     * @return
+     *     The value rendered as text is returned.
+     */
+    std::string ToString() const;
+};
+
+/**
+ * This computes hash values of answers, so that answers can be
+ * used as keys in unordered containers.  Because answers are kept
+ * in canonical form, equal answers always have the same hash value.
+ */
+struct AnswerValueHash {
+    /**
+     * This computes the hash value of the given answer.
+     *
+     * @param[in] value
+     *     This is the answer whose hash value to compute.
+     *
+     * @return
+     *     The hash value of the answer is returned.
+     */
+    size_t operator()(const AnswerValue& value) const;
+};
+
+/**
+ * These are the kinds of text which can be evaluated as answers.
+ */
+enum class AnswerSyntax {
+    /**
+     * This accepts only a single number, which may be negative, and may
+     * be written as a whole number (e.g. "42"), a decimal (e.g. "42.0"),
+     * or a fraction (e.g. "84/2").
+     */
+    Number,
+
+    /**
+     * This accepts arithmetic expressions of numbers (as above)
+     * combined with the operators +, -, *, and /, and parentheses.
+     */
+    Expression,
+};
+
+/**
+ * This function evaluates the given text as an answer, normalizing
+ * it to its canonical value.  Whitespace before and after the answer,
+ * and between the parts of an expression, is ignored.
+ *
+ * @param[in] text
+ *     This is the text to evaluate.
+ *
+ * @param[in] syntax
+ *     This indicates the kind of text which is accepted.
+ *
+ * @param[out] value
+ *     This is where to store the value of the answer.
+ *
+ * @return
+ *     An indication of whether or not the text was accepted and
+ *     evaluated is returned.  Text is rejected if it isn't of the kind
+ *     accepted, or if evaluating it would overflow or divide by zero.
+ */
+bool EvaluateAnswer(
+    const std::string& text,
+    AnswerSyntax syntax,
+    AnswerValue& value
+);
+
+/**
+ * This function does the same as EvaluateAnswer, except that short
+ * whole numbers are parsed like any other answer, rather than taking
+ * the fast path reserved for them.  It's used to check and measure
+ * the fast path against the parser.
+ *
+ * @param[in] text
+ *     This is the text to evaluate.
+ *
+ * @param[in] syntax
+ *     This indicates the kind of text which is accepted.
+ *
+ * @param[out] value
+ *     This is where to store the value of the answer.
+ *
+ * @return
+ *     An indication of whether or not the text was accepted and
+ *     evaluated is returned.
+ */
+bool EvaluateAnswerWithoutFastPath(
+    const std::string& text,
+    AnswerSyntax syntax,
+    AnswerValue& value
+);
+
+#endif /* ANSWER_EVALUATOR_HPP */
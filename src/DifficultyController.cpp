@@ -0,0 +1,107 @@
+/**
+ * @file DifficultyController.cpp
+ *
+ * This module contains the implementation of the DifficultyController class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "DifficultyController.hpp"
+
+namespace {
+
+    /**
+     * This is the weight given to the latest round when updating
+     * the moving averages.
+     */
+    constexpr double SMOOTHING_FACTOR = 0.3;
+
+    /**
+     * This is how far, as a fraction of the target, the average time
+     * to answer correctly may stray from the target before the
+     * difficulty level is changed.
+     */
+    constexpr double SOLVE_TIME_TOLERANCE = 0.25;
+
+    /**
+     * This is the largest average fraction of wrong answers for which
+     * the difficulty level may be raised.  Above this, the difficulty
+     * level is lowered instead.
+     */
+    constexpr double MAX_WRONG_ANSWER_RATIO = 0.5;
+
+    /**
+     * This function updates the given exponentially-weighted
+     * moving average with the given sample.
+     *
+     * @param[in,out] average
+     *     This is the moving average to update.
+     *
+     * @param[in] sample
+     *     This is the sample with which to update the average.
+     */
+    void UpdateAverage(
+        double& average,
+        double sample
+    ) {
+        average += SMOOTHING_FACTOR * (sample - average);
+    }
+
+}
+
+constexpr int DifficultyController::MAX_LEVEL;
+
+int DifficultyController::GetLevel() const {
+    return level;
+}
+
+void DifficultyController::RecordRound(
+    bool solved,
+    double timeToCorrect,
+    size_t answers,
+    size_t wrongAnswers
+) {
+    // A round with no answers at all counts as a miss: nobody solved
+    // the question in time, though it says nothing about how many
+    // answers are wrong.
+    UpdateAverage(averageTimeToCorrect, timeToCorrect);
+    if (answers > 0) {
+        UpdateAverage(averageWrongAnswerRatio, (double)wrongAnswers / (double)answers);
+    }
+    if (
+        !solved
+        || (averageTimeToCorrect > targetSolveTime * (1.0 + SOLVE_TIME_TOLERANCE))
+        || (averageWrongAnswerRatio > MAX_WRONG_ANSWER_RATIO)
+    ) {
+        if (level > 0) {
+            --level;
+        }
+    } else if (averageTimeToCorrect < targetSolveTime * (1.0 - SOLVE_TIME_TOLERANCE)) {
+        if (level < MAX_LEVEL) {
+            ++level;
+        }
+    }
+}
+
+void DifficultyController::WriteState(std::ostream& stream) const {
+    stream
+        << level << ' '
+        << averageTimeToCorrect << ' '
+        << averageWrongAnswerRatio;
+}
+
+bool DifficultyController::ReadState(std::istream& stream) {
+    int newLevel;
+    double newAverageTimeToCorrect, newAverageWrongAnswerRatio;
+    if (
+        !(stream >> newLevel >> newAverageTimeToCorrect >> newAverageWrongAnswerRatio)
+        || (newLevel < 0)
+        || (newLevel > MAX_LEVEL)
+    ) {
+        return false;
+    }
+    level = newLevel;
+    averageTimeToCorrect = newAverageTimeToCorrect;
+    averageWrongAnswerRatio = newAverageWrongAnswerRatio;
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef DIFFICULTY_CONTROLLER_HPP
+#define DIFFICULTY_CONTROLLER_HPP
+
+/**
+ * @file DifficultyController.hpp
+ *
+ * This module declares the DifficultyController implementation.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <istream>
+#include <ostream>
+#include <stddef.h>
+
+/**
+ * This picks how difficult the math questions asked in one channel
+ * should be, in order to have questions solved in about a target
+ * amount of time.
+ *
+ * It keeps exponentially-weighted moving averages of how long it takes
+ * for a question to be answered correctly, and of what fraction
+ * of answers given are wrong.  After each round, it nudges the
+ * difficulty level up if questions are being solved too quickly,
+ * or down if they're being solved too slowly (or not at all), or if
+ * too many wrong answers are being given.  Each update takes
+ * constant time, regardless of how many rounds have been played.
+ */
+class DifficultyController {
+    // Public Methods
+public:
+    /**
+     * This method returns the difficulty level of the next question.
+     *
+     * @return
+     *     The difficulty level of the next question is returned.
+     *     It ranges from zero (easiest) to MAX_LEVEL (hardest).
+     */
+    int GetLevel() const;
+
+    /**
+     * This method updates the statistics kept by the controller
+     * with the results of a round, and adjusts the difficulty level
+     * accordingly.  Rounds in which no answers were given should
+     * be recorded too, as unsolved, so that questions get easier
+     * in channels where nobody answers them.
+     *
+     * @param[in] solved
+     *     This indicates whether or not the question was answered
+     *     correctly before the round ended.
+     *
+     * @param[in] timeToCorrect
+     *     If the question was answered correctly, this is the number
+     *     of seconds between when the question was asked and when
+     *     the correct answer was received.  Otherwise, this should be
+     *     the length of the round.
+     *
+     * @param[in] answers
+     *     This is the number of answers given during the round.
+     *
+     * @param[in] wrongAnswers
+     *     This is the number of wrong answers given during the round.
+     */
+    void RecordRound(
+        bool solved,
+        double timeToCorrect,
+        size_t answers,
+        size_t wrongAnswers
+    );
+
+    /**
+     * This method writes the state of the controller to the given stream.
+     *
+     * @param[in,out] stream
+     *     This is the stream to which to write the state.
+     */
+    void WriteState(std::ostream& stream) const;
+
+    /**
+     * This method restores the state of the controller from a stream
+     * previously written by WriteState.
+     *
+     * @param[in,out] stream
+     *     This is the stream from which to read the state.
+     *
+     * @return
+     *     An indication of whether or not the state was restored
+     *     is returned.
+     */
+    bool ReadState(std::istream& stream);
+
+    // Public Properties
+public:
+    /**
+     * This is the hardest difficulty level.
+     */
+    static constexpr int MAX_LEVEL = 9;
+
+    /**
+     * This is the number of seconds in which the controller tries
+     * to have questions solved.
+     */
+    double targetSolveTime = 6.0;
+
+    // Private properties
+private:
+    /**
+     * This is the difficulty level of the next question.
+     */
+    int level = 3;
+
+    /**
+     * This is the moving average of the number of seconds it takes
+     * for a question to be answered correctly.
+     */
+    double averageTimeToCorrect = 6.0;
+
+    /**
+     * This is the moving average of the fraction of answers
+     * which are wrong.
+     */
+    double averageWrongAnswerRatio = 0.0;
+};
+
+#endif /* DIFFICULTY_CONTROLLER_HPP */
@@ -0,0 +1,36 @@
+/**
+ * @file Fnv1a.cpp
+ *
+ * This module contains the implementation of the Fnv1a function.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Fnv1a.hpp"
+
+namespace {
+
+    /**
+     * This is the value with which the 64-bit FNV-1a hash starts.
+     */
+    constexpr uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+
+    /**
+     * This is the number by which the 64-bit FNV-1a hash is multiplied
+     * after each character is mixed in.
+     */
+    constexpr uint64_t PRIME = 1099511628211ULL;
+
+}
+
+uint64_t Fnv1a(
+    const char* chars,
+    size_t length
+) {
+    uint64_t hash = OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)chars[i];
+        hash *= PRIME;
+    }
+    return hash;
+}
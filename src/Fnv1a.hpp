@@ -0,0 +1,32 @@
+#ifndef FNV1A_HPP
+#define FNV1A_HPP
+
+/**
+ * @file Fnv1a.hpp
+ *
+ * This module declares the Fnv1a function.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * This function computes the 64-bit FNV-1a hash of the given characters.
+ *
+ * @param[in] chars
+ *     This points to the characters to hash.
+ *
+ * @param[in] length
+ *     This is the number of characters to hash.
+ *
+ * @return
+ *     The hash of the characters is returned.
+ */
+uint64_t Fnv1a(
+    const char* chars,
+    size_t length
+);
+
+#endif /* FNV1A_HPP */
@@ -6,22 +6,42 @@
  * © 2018 by Richard Walters
  */
 
+#include "AnswerEvaluator.hpp"
+#include "DifficultyController.hpp"
 #include "MathBot2001.hpp"
+#include "MessageIdFilter.hpp"
+#include "MessagePool.hpp"
+#include "MpscRingBuffer.hpp"
+#include "ScoreWindows.hpp"
+#include "Serialization.hpp"
+#include "StringInterner.hpp"
 #include "TimeKeeper.hpp"
+#include "Tracer.hpp"
+#include "Transcript.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <map>
 #include <mutex>
+#include <queue>
 #include <random>
-#include <set>
+#include <stdint.h>
+#include <stdio.h>
 #include <sstream>
 #include <string>
 #include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
 #include <SystemAbstractions/File.hpp>
 #include <thread>
+#include <unordered_map>
 #include <Twitch/Messaging.hpp>
 #include <TwitchNetworkTransport/Connection.hpp>
+#include <vector>
 
 namespace {
 
@@ -31,26 +51,598 @@ namespace {
      */
     constexpr unsigned int WORKER_POLLING_PERIOD_MILLISECONDS = 50;
 
+    /**
+     * This is the number of seconds ahead of its scheduled time
+     * that the next math question is prepared and handed to the sender.
+     */
+    constexpr double QUESTION_PREPARATION_LEAD = 1.0;
+
+    /**
+     * This is the number of questions made up when preparing the next
+     * question before giving up, if each one's answer is the same as
+     * the last question's, or as that of a question still open.
+     */
+    constexpr size_t MAX_QUESTION_ATTEMPTS = 32;
+
+    /**
+     * This is the number of queued messages a channel may have handled
+     * each time the worker thread visits it, when other channels also
+     * have messages waiting.
+     */
+    constexpr size_t MESSAGE_QUANTUM = 16;
+
+    /**
+     * This is the maximum number of messages which may be waiting
+     * to be handled for any one channel.  Messages received for a channel
+     * whose queue is full are dropped.
+     */
+    constexpr size_t MAX_CHANNEL_QUEUE_DEPTH = 1000;
+
+    /**
+     * This is the number of messages which may be waiting to be taken
+     * by the worker thread from the thread receiving them from Twitch.
+     * Messages received while this many are waiting are dropped.
+     */
+    constexpr size_t INBOUND_QUEUE_CAPACITY = 4096;
+
+    /**
+     * This is the largest number of messages the worker thread takes
+     * from the inbound queue at a time, before serving any deadlines.
+     */
+    constexpr size_t INBOUND_BATCH_SIZE = 256;
+
+    /**
+     * This is the number of messages held in the message pool, which
+     * bounds the number of messages received but not yet handled,
+     * across the inbound queue and all channel queues.
+     */
+    constexpr size_t MESSAGE_POOL_SIZE = 8192;
+
+    /**
+     * This is the number of contestants whose points are changed,
+     * or copied out, each time the object's mutex is locked
+     * while importing or exporting scores.
+     */
+    constexpr size_t SCORE_BATCH_SIZE = 4096;
+
+    /**
+     * This is the number of contestants listed in response
+     * to a leaderboard request.
+     */
+    constexpr size_t LEADERBOARD_SIZE = 5;
+
+    /**
+     * This is the minimum number of seconds between leaderboards
+     * sent to the same channel, so that a flood of requests
+     * doesn't flood the channel with leaderboards.
+     */
+    constexpr double LEADERBOARD_COOLDOWN = 10.0;
+
+    /**
+     * This is the number of seconds late a question may be sent,
+     * or a round may be scored, before it counts as a missed deadline.
+     */
+    constexpr double DEADLINE_MISS_TOLERANCE = 0.25;
+
+    /**
+     * This is the number of message IDs remembered in order to
+     * detect messages received more than once.
+     */
+    constexpr size_t MESSAGE_ID_FILTER_CAPACITY = 65536;
+
+    /**
+     * This is the number of seconds for which message IDs are
+     * remembered in order to detect messages received more than once.
+     */
+    constexpr double MESSAGE_ID_FILTER_WINDOW = 600.0;
+
+    /**
+     * This is the first part of the first line of every snapshot file,
+     * which is followed by the version of the snapshot format.
+     */
+    const std::string SNAPSHOT_HEADER = "MathBot2001 snapshot ";
+
+    /**
+     * This is the version of the snapshot format written by the bot.
+     * Version 2 added the state of each channel's difficulty controller.
+     * Version 3 replaced each channel's current round with its list
+     * of open rounds.
+     * Version 4 added each channel's daily, weekly, and season totals
+     * of contestants' points.
+     */
+    constexpr int SNAPSHOT_VERSION = 4;
+
     /**
      * This represents one user who is interacting with the bot.
      */
     struct Contestant {
         /**
-         * This is the user's nickname.
+         * This is the user's current score.
          */
-        std::string nickname;
+        int points = 0;
+    };
 
+    /**
+     * This holds everything the bot keeps track of for one math question
+     * which has been asked, from when it's asked until it's scored.
+     */
+    struct Round {
         /**
-         * This is the user's current score.
+         * This is the ID of the round within its channel.
          */
-        int points = 0;
+        unsigned int id = 0;
+
+        /**
+         * This is the arithmetic expression the question asked about.
+         */
+        std::string expression;
+
+        /**
+         * This is the correct answer to the question.
+         */
+        AnswerValue answer;
 
         /**
-         * This is the number of points gained or lost this round.
+         * This indicates whether or not a user has sent a tell
+         * with the correct answer to the question.
          */
-        int pointDelta = 0;
+        bool complete = false;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the question was scheduled to be asked.
+         */
+        double scheduledTime = 0.0;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the question was actually sent.
+         */
+        double sentTime = 0.0;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the round should be scored.
+         */
+        double scoringTime = 0.0;
+
+        /**
+         * These are the numbers of points gained or lost this round,
+         * keyed by the IDs of the nicknames of the users
+         * who participated.
+         */
+        std::map< size_t, int > pointDeltas;
+
+        /**
+         * This is the ID of the nickname of the user who won the round,
+         * or StringInterner::NOT_FOUND if no user has won it.
+         */
+        size_t winner = StringInterner::NOT_FOUND;
+
+        /**
+         * If there is a user who won the round, this is the `id`
+         * of the message they sent containing the winning answer.
+         */
+        std::string winningMsgId;
+
+        /**
+         * This is the number of answers given this round.
+         */
+        size_t answers = 0;
+
+        /**
+         * This is the number of wrong answers given this round.
+         */
+        size_t wrongAnswers = 0;
+
+        /**
+         * If the question has been answered correctly,
+         * this is the number of seconds it took.
+         */
+        double timeToCorrect = 0.0;
     };
 
+    /**
+     * This function writes the given round to the given stream,
+     * in the form read back by ReadSnapshotRound.
+     *
+     * @param[in,out] stream
+     *     This is the stream to which to write the round.
+     *
+     * @param[in] round
+     *     This is the round to write.
+     *
+     * @param[in] nicknames
+     *     This holds the nicknames of the users who participated
+     *     in the round.
+     */
+    void WriteSnapshotRound(
+        std::ostream& stream,
+        const Round& round,
+        const StringInterner& nicknames
+    ) {
+        stream
+            << round.complete
+            << ' ' << round.scheduledTime
+            << ' ' << round.sentTime
+            << ' ' << round.scoringTime
+            << ' ' << round.answers
+            << ' ' << round.wrongAnswers
+            << ' ' << round.timeToCorrect
+            << ' ';
+        WriteSnapshotString(stream, round.expression);
+        stream << ' ';
+        WriteSnapshotString(stream, round.answer.ToString());
+        stream << ' ';
+        WriteSnapshotString(
+            stream,
+            (
+                (round.winner == StringInterner::NOT_FOUND)
+                ? std::string()
+                : nicknames.GetString(round.winner)
+            )
+        );
+        stream << ' ';
+        WriteSnapshotString(stream, round.winningMsgId);
+        stream << ' ' << round.pointDeltas.size();
+        for (const auto& pointDeltasEntry: round.pointDeltas) {
+            stream << ' ';
+            WriteSnapshotString(stream, nicknames.GetString(pointDeltasEntry.first));
+            stream << ' ' << pointDeltasEntry.second;
+        }
+    }
+
+    /**
+     * This function reads a round written by WriteSnapshotRound
+     * from the given stream.
+     *
+     * @param[in,out] stream
+     *     This is the stream from which to read the round.
+     *
+     * @param[out] round
+     *     This is where to store the round read.
+     *
+     * @param[in,out] nicknames
+     *     This is used to assign IDs to the nicknames of the users
+     *     who participated in the round.
+     *
+     * @return
+     *     An indication of whether or not the round was read is returned.
+     */
+    bool ReadSnapshotRound(
+        std::istream& stream,
+        Round& round,
+        StringInterner& nicknames
+    ) {
+        std::string answer, winner;
+        size_t numParticipants;
+        if (
+            !(
+                stream
+                >> round.complete
+                >> round.scheduledTime
+                >> round.sentTime
+                >> round.scoringTime
+                >> round.answers
+                >> round.wrongAnswers
+                >> round.timeToCorrect
+            )
+            || !ReadSnapshotString(stream >> std::ws, round.expression)
+            || !ReadSnapshotString(stream >> std::ws, answer)
+            || !EvaluateAnswer(answer, AnswerSyntax::Number, round.answer)
+            || !ReadSnapshotString(stream >> std::ws, winner)
+            || !ReadSnapshotString(stream >> std::ws, round.winningMsgId)
+            || !(stream >> numParticipants)
+        ) {
+            return false;
+        }
+        if (!winner.empty()) {
+            round.winner = nicknames.Intern(winner);
+        }
+        for (size_t i = 0; i < numParticipants; ++i) {
+            std::string participant;
+            int pointDelta;
+            if (
+                !ReadSnapshotString(stream >> std::ws, participant)
+                || !(stream >> pointDelta)
+            ) {
+                return false;
+            }
+            round.pointDeltas[nicknames.Intern(participant)] = pointDelta;
+        }
+        return true;
+    }
+
+    /**
+     * This holds everything the bot keeps track of for one channel
+     * in which it asks questions.
+     */
+    struct Channel {
+        /**
+         * This is the name of the channel.
+         */
+        std::string name;
+
+        /**
+         * This is the ID of the channel's lowercase name among the names
+         * of all channels in which the bot participates.
+         */
+        size_t id = 0;
+
+        /**
+         * This indicates whether or not the bot was asked to participate
+         * in the channel, as opposed to just remembering it from
+         * a snapshot.
+         */
+        bool requested = false;
+
+        /**
+         * This indicates whether or not the bot is currently
+         * in the channel.
+         */
+        bool joined = false;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the next math question should be asked.
+         */
+        double nextQuestionTime = std::numeric_limits< double >::max();
+
+        /**
+         * This indicates whether or not the next math question has been
+         * prepared and is waiting for the sender thread to send it.
+         */
+        bool questionPrepared = false;
+
+        /**
+         * This is incremented whenever a math question is prepared,
+         * so that the sender thread can tell whether the question it
+         * just sent is still the one prepared, since the channel may
+         * have been left (and even rejoined) while it was sending.
+         */
+        unsigned int preparedQuestionGeneration = 0;
+
+        /**
+         * This is the arithmetic expression the next math question
+         * asks about, prepared ahead of time.
+         */
+        std::string preparedExpression;
+
+        /**
+         * This is the correct answer to the next math question.
+         */
+        AnswerValue preparedAnswer;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the prepared math question is scheduled to be asked.
+         */
+        double preparedQuestionTime = std::numeric_limits< double >::max();
+
+        /**
+         * This is the correct answer to the math question
+         * most recently asked.
+         */
+        AnswerValue lastAnswer;
+
+        /**
+         * These are the rounds which have been started but not yet
+         * scored, keyed by round ID.  Round IDs increase in the order
+         * in which the questions were asked.
+         */
+        std::map< unsigned int, Round > rounds;
+
+        /**
+         * This is the ID to give the next round started.
+         */
+        unsigned int nextRoundId = 0;
+
+        /**
+         * This indexes the rounds which have not yet been scored
+         * by the answers to their questions.  No two of these rounds
+         * have the same answer.
+         */
+        std::unordered_map< AnswerValue, Round*, AnswerValueHash > openAnswers;
+
+        /**
+         * These are the users who are currently interacting with the bot
+         * in this channel.
+         */
+        std::map< size_t, Contestant > contestants;
+
+        /**
+         * These are the totals of the points contestants gained
+         * or lost in this channel over the last day, the last week,
+         * and the current season.
+         */
+        ScoreWindows scoreWindows;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * a leaderboard was last sent to the channel.
+         */
+        double lastLeaderboardTime = std::numeric_limits< double >::lowest();
+
+        /**
+         * This is used to pick how difficult questions should be
+         * in this channel.
+         */
+        DifficultyController difficulty;
+
+        /**
+         * This holds the messages received in this channel which
+         * have not yet been handled, in a circular buffer which is
+         * allocated when the first message is queued.
+         */
+        std::vector< PooledMessage* > inbound;
+
+        /**
+         * This is the index in the inbound buffer of the oldest message
+         * not yet handled.
+         */
+        size_t inboundHead = 0;
+
+        /**
+         * This is the number of messages in the inbound buffer.
+         */
+        size_t inboundCount = 0;
+
+        /**
+         * This is the number of queued messages the channel is still
+         * allowed to have handled before other waiting channels get a turn.
+         */
+        size_t deficit = 0;
+
+        /**
+         * This is the largest number of messages which have been
+         * waiting at once since the last round was scored.
+         */
+        size_t peakQueueDepth = 0;
+
+        /**
+         * This is the number of messages dropped because the channel's
+         * queue was full, since the last round was scored.
+         */
+        size_t messagesDropped = 0;
+
+        /**
+         * This is the number of times a question was sent, or a round
+         * was scored, later than its deadline allows.
+         */
+        size_t deadlineMisses = 0;
+    };
+
+    /**
+     * This function returns the number which identifies the given round
+     * in the given channel in traces.
+     *
+     * @param[in] channel
+     *     This is the channel in which the round is played.
+     *
+     * @param[in] roundId
+     *     This is the ID of the round.
+     *
+     * @return
+     *     The number which identifies the round in traces is returned.
+     */
+    uint64_t GetRoundTraceId(
+        const Channel& channel,
+        unsigned int roundId
+    ) {
+        return ((uint64_t)channel.id << 32) | roundId;
+    }
+
+    /**
+     * These are the kinds of things the worker thread does
+     * at scheduled times.
+     */
+    enum class DeadlineKind {
+        /**
+         * This is when the next math question for a channel
+         * should be prepared.
+         */
+        PrepareQuestion,
+
+        /**
+         * This is when a round should be scored.
+         */
+        ScoreRound,
+    };
+
+    /**
+     * This represents something the worker thread should do
+     * at a scheduled time.
+     */
+    struct Deadline {
+        /**
+         * This is the time (according to the time keeper) when
+         * the deadline comes due.
+         */
+        double time = 0.0;
+
+        /**
+         * This indicates what should be done when the deadline comes due.
+         */
+        DeadlineKind kind = DeadlineKind::PrepareQuestion;
+
+        /**
+         * This is the channel for which something should be done.
+         */
+        Channel* channel = nullptr;
+
+        /**
+         * If the deadline is for scoring a round, this is
+         * the ID of the round to score.
+         */
+        unsigned int roundId = 0;
+
+        /**
+         * This is the "greater than" operator, used to order deadlines
+         * so that the earliest comes out first.
+         *
+         * @param[in] other
+         *     This is the other deadline to which to compare this one.
+         *
+         * @return
+         *     An indication of whether or not this deadline comes due
+         *     after the other deadline is returned.
+         */
+        bool operator>(const Deadline& other) const {
+            return time > other.time;
+        }
+    };
+
+    /**
+     * This function adds a message to the end of the given channel's
+     * queue of messages waiting to be handled.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose queue to add the message to.
+     *
+     * @param[in] message
+     *     This is the message to add.
+     *
+     * @return
+     *     An indication of whether or not the message was added
+     *     is returned.  This is false if the queue is full.
+     */
+    bool PushInbound(
+        Channel& channel,
+        PooledMessage* message
+    ) {
+        if (channel.inbound.empty()) {
+            channel.inbound.resize(MAX_CHANNEL_QUEUE_DEPTH);
+        }
+        if (channel.inboundCount >= channel.inbound.size()) {
+            return false;
+        }
+        const auto tail = (channel.inboundHead + channel.inboundCount) % channel.inbound.size();
+        channel.inbound[tail] = message;
+        ++channel.inboundCount;
+        return true;
+    }
+
+    /**
+     * This function removes the oldest message from the given channel's
+     * queue of messages waiting to be handled.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose queue to remove the message from.
+     *
+     * @return
+     *     The message removed is returned, or nullptr if the queue
+     *     is empty.
+     */
+    PooledMessage* PopInbound(Channel& channel) {
+        if (channel.inboundCount == 0) {
+            return nullptr;
+        }
+        const auto message = channel.inbound[channel.inboundHead];
+        channel.inboundHead = (channel.inboundHead + 1) % channel.inbound.size();
+        --channel.inboundCount;
+        return message;
+    }
+
 }
 
 /**
@@ -62,371 +654,1445 @@ struct MathBot2001::Impl
     // Properties
 
     /**
-     * This is a helper object used to generate and publish
-     * diagnostic messages.
+     * This is a helper object used to generate and publish
+     * diagnostic messages.
+     */
+    SystemAbstractions::DiagnosticsSender diagnosticsSender;
+
+    /**
+     * This is the nickname to use on Twitch.
+     */
+    std::string nickname;
+
+    /**
+     * This is used to connect to Twitch chat and exchange messages
+     * with it.
+     */
+    Twitch::Messaging tmi;
+
+    /**
+     * This is used to track elapsed real time.
+     */
+    std::shared_ptr< TimeKeeper > timeKeeper = std::make_shared< TimeKeeper >();
+
+    /**
+     * This is used to record chat messages received, if enabled.
+     */
+    TranscriptRecorder transcriptRecorder;
+
+    /**
+     * This flag indicates whether or not a failure to write
+     * the transcript has been reported.
+     */
+    bool transcriptFailureReported = false;
+
+    /**
+     * This is used to record a timeline of what each thread does
+     * during each round, if enabled.
+     */
+    Tracer tracer;
+
+    /**
+     * This is used to synchronize access to the object.
+     */
+    std::mutex mutex;
+
+    /**
+     * This is used to signal when any condition for which the main thread
+     * may be waiting has occurred.
+     */
+    std::condition_variable mainThreadEvent;
+
+    /**
+     * This flag is set when the Twitch messaging interface indicates
+     * that the bot has been logged out of Twitch.
+     */
+    bool loggedOut = false;
+
+    /**
+     * This is used to notify the worker thread about
+     * any change that should cause it to wake up.
+     */
+    std::condition_variable_any workerWakeCondition;
+
+    /**
+     * This is used to have the bot
+     * take action at certain points in time.
+     */
+    std::thread workerThread;
+
+    /**
+     * This flag indicates whether or not the worker thread
+     * and sender thread should stop.
+     */
+    bool stopWorker = false;
+
+    /**
+     * This flag indicates whether or not the worker thread and
+     * sender thread are being stopped, in which case they must not
+     * be started again until they've stopped.
+     */
+    bool stoppingWorker = false;
+
+    /**
+     * This flag indicates whether or not the bot is exiting,
+     * in which case the worker thread and sender thread
+     * must not be started again.
+     */
+    bool exiting = false;
+
+    /**
+     * This is used to notify the sender thread about
+     * any change that should cause it to wake up.
+     */
+    std::condition_variable_any senderWakeCondition;
+
+    /**
+     * This is used to send each math question at the time
+     * it is scheduled to be asked.
+     */
+    std::thread senderThread;
+
+    /**
+     * This is used to generate the math questions.
+     */
+    std::mt19937 generator;
+
+    /**
+     * This indicates whether or not the generator has been seeded,
+     * or had its state restored from a snapshot.
+     */
+    bool generatorSeeded = false;
+
+    /**
+     * This is the path of the file from which the bot's state was
+     * restored, and to which it's saved when logging out, or an empty
+     * string if the bot's state isn't saved.
+     */
+    std::string snapshotPath;
+
+    /**
+     * This is the minimum cooldown time in seconds between
+     * when two consecutive questions are asked.
+     */
+    double minQuestionCooldown = 45.0;
+
+    /**
+     * This is the maximum cooldown time in seconds between
+     * when two consecutive questions are asked.
+     */
+    double maxQuestionCooldown = 180.0;
+
+    /**
+     * This is the amount of time a question/answer round will go
+     * until the scoring is done.
      */
-    SystemAbstractions::DiagnosticsSender diagnosticsSender;
+    double roundTime = 15.0;
 
     /**
-     * This is the name of the channel to join in Twitch.
+     * This is the largest number of questions which may be open
+     * (asked but not yet scored) at once in any one channel.
      */
-    std::string channel;
+    size_t maxOpenQuestions = 1;
 
     /**
-     * This is the nickname to use on Twitch.
+     * These are the channels in which the bot participates,
+     * keyed by lowercase channel name.
      */
-    std::string nickname;
+    std::map< std::string, Channel > channels;
 
     /**
-     * This is used to connect to Twitch chat and exchange messages
-     * with it.
+     * These are the channels which have messages waiting to be handled,
+     * in the order in which the worker thread will visit them.
      */
-    Twitch::Messaging tmi;
+    std::deque< Channel* > channelsWithMessages;
 
     /**
-     * This is used to track elapsed real time.
+     * These are the times at which the worker thread should prepare
+     * questions or score rounds, in all channels, with the earliest
+     * first.  Deadlines which no longer apply are left in place
+     * and skipped when they come due.
      */
-    std::shared_ptr< TimeKeeper > timeKeeper = std::make_shared< TimeKeeper >();
+    std::priority_queue<
+        Deadline,
+        std::vector< Deadline >,
+        std::greater< Deadline >
+    > deadlines;
 
     /**
-     * This is used to synchronize access to the object.
+     * These are the channels in which the bot participates, indexed
+     * by the IDs of their lowercase names in channelNames.
      */
-    std::mutex mutex;
+    std::vector< Channel* > channelsById;
 
     /**
-     * This is used to signal when any condition for which the main thread
-     * may be waiting has occurred.
+     * This assigns IDs to the lowercase names of the channels in which
+     * the bot participates, so that the channel to which a message was
+     * sent can be found without allocating memory.
      */
-    std::condition_variable mainThreadEvent;
+    StringInterner channelNames;
 
     /**
-     * This flag is set when the Twitch messaging interface indicates
-     * that the bot has been logged out of Twitch.
+     * This assigns IDs to the nicknames of contestants, so that each
+     * nickname is only stored once, and contestants and rounds can
+     * keep track of users by ID.  Users are only given IDs once
+     * they answer a question, so the nicknames of users who just chat
+     * are never kept, and the number of nicknames is bounded by
+     * the number of contestants, whose scores are kept anyway.
      */
-    bool loggedOut = false;
+    StringInterner nicknames;
 
     /**
-     * This is used to notify the worker thread about
-     * any change that should cause it to wake up.
+     * This holds the storage reused for messages received from Twitch.
      */
-    std::condition_variable_any workerWakeCondition;
+    MessagePool messagePool;
 
     /**
-     * This is used to have the bot
-     * take action at certain points in time.
+     * This holds messages received from Twitch, until the worker thread
+     * takes them to be handled.  The thread receiving messages
+     * pushes onto it without locking the object's mutex, so that it
+     * never has to wait for the worker thread.
      */
-    std::thread workerThread;
+    MpscRingBuffer< PooledMessage* > inboundQueue;
 
     /**
-     * This flag indicates whether or not the worker thread should stop.
+     * This is the number of messages dropped because the inbound
+     * queue or the message pool was full, not yet reported.
      */
-    bool stopWorker = false;
+    std::atomic< size_t > inboundMessagesDropped{0};
 
     /**
-     * This is used to generate the math questions.
+     * This is used to detect messages received more than once,
+     * so that they aren't handled (and scored) again.
      */
-    std::mt19937 generator;
+    MessageIdFilter messageIdFilter;
+
+    // Methods
 
     /**
-     * This indicates whether or not a user has sent a tell
-     * with the correct answer to the current math question,
-     * or if the round has finished before anyone could answer
-     * the question correctly.
+     * This is the default constructor.
      */
-    bool roundComplete = true;
+    Impl()
+        : diagnosticsSender("MathBot2001")
+        , messagePool(MESSAGE_POOL_SIZE)
+        , inboundQueue(INBOUND_QUEUE_CAPACITY)
+        , messageIdFilter(MESSAGE_ID_FILTER_CAPACITY, MESSAGE_ID_FILTER_WINDOW)
+    {
+    }
 
     /**
-     * This indicates whether or not the current round has been scored.
+     * This method assigns IDs to the names of any channels which
+     * don't have them yet, so that messages can be matched up
+     * with their channels.
      */
-    bool roundScored = true;
+    void IndexChannels() {
+        for (auto& channelsEntry: channels) {
+            const auto channelId = channelNames.Intern(channelsEntry.first);
+            if (channelId >= channelsById.size()) {
+                channelsById.resize(channelId + 1);
+            }
+            channelsById[channelId] = &channelsEntry.second;
+            channelsEntry.second.id = channelId;
+        }
+    }
 
     /**
-     * This is the time (according to the time keeper) when
-     * the next math question should be asked.
+     * This method advances the time of when the next question
+     * will be asked in the given channel.  The cooldown is shortened
+     * in proportion to the number of questions which may be open
+     * at once, so that each question is open for about as long
+     * as it would be if only one were asked at a time.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose schedule to update.
      */
-    double nextQuestionTime = std::numeric_limits< double >::max();
+    void UpdateNextQuestionTime(Channel& channel) {
+        channel.nextQuestionTime += std::uniform_real_distribution<>(
+            minQuestionCooldown,
+            maxQuestionCooldown
+        )(generator) / maxOpenQuestions;
+        ScheduleDeadline(
+            channel.nextQuestionTime - QUESTION_PREPARATION_LEAD,
+            DeadlineKind::PrepareQuestion,
+            channel
+        );
+    }
 
     /**
-     * This is the time (according to the time keeper) when
-     * the current math question should be scored.
+     * This method schedules the worker thread to prepare a question
+     * or score a round at the given time.
+     *
+     * @param[in] time
+     *     This is the time (according to the time keeper) when
+     *     the deadline comes due.
+     *
+     * @param[in] kind
+     *     This indicates what should be done when the deadline comes due.
+     *
+     * @param[in,out] channel
+     *     This is the channel for which something should be done.
+     *
+     * @param[in] roundId
+     *     If the deadline is for scoring a round, this is
+     *     the ID of the round to score.
      */
-    double currentScoringTime = std::numeric_limits< double >::max();
+    void ScheduleDeadline(
+        double time,
+        DeadlineKind kind,
+        Channel& channel,
+        unsigned int roundId = 0
+    ) {
+        Deadline deadline;
+        deadline.time = time;
+        deadline.kind = kind;
+        deadline.channel = &channel;
+        deadline.roundId = roundId;
+        deadlines.push(deadline);
+    }
 
     /**
-     * This is the minimum cooldown time in seconds between
-     * when two consecutive questions are asked.
+     * This method rebuilds the index of the given channel's open
+     * rounds by the answers to their questions.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose index to rebuild.
      */
-    double minQuestionCooldown = 45.0;
+    void IndexOpenAnswers(Channel& channel) {
+        channel.openAnswers.clear();
+        for (auto& roundsEntry: channel.rounds) {
+            auto& round = roundsEntry.second;
+            channel.openAnswers[round.answer] = &round;
+        }
+    }
+
+   /**
+     * This is method starts the worker thread if it isn't running.
+     */
+    void StartWorker() {
+        if (
+            workerThread.joinable()
+            || stoppingWorker
+            || exiting
+        ) {
+            return;
+        }
+        stopWorker = false;
+        if (!generatorSeeded) {
+            generator.seed((int)time(NULL));
+            generatorSeeded = true;
+        }
+        workerThread = std::thread(&Impl::Worker, this);
+        senderThread = std::thread(&Impl::Sender, this);
+    }
 
     /**
-     * This is the maximum cooldown time in seconds between
-     * when two consecutive questions are asked.
+     * This method stops the worker thread if it's running.
+     * It may be called from more than one thread at a time.
      */
-    double maxQuestionCooldown = 180.0;
+    void StopWorker() {
+        std::thread stoppingWorkerThread, stoppingSenderThread;
+        {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (!workerThread.joinable()) {
+                return;
+            }
+            stopWorker = true;
+            stoppingWorker = true;
+            workerWakeCondition.notify_all();
+            senderWakeCondition.notify_all();
+            stoppingWorkerThread = std::move(workerThread);
+            stoppingSenderThread = std::move(senderThread);
+        }
+        stoppingWorkerThread.join();
+        stoppingSenderThread.join();
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        stoppingWorker = false;
+    }
 
     /**
-     * This is the amount of time a question/answer round will go
-     * until the scoring is done.
+     * This method makes up the next math question and its answer
+     * for the given channel, and hands them to the sender thread
+     * to be asked at the currently scheduled time, or right away
+     * if that time has already passed.  If no question can be found
+     * whose answer differs from those of the questions still open,
+     * the question is skipped.
+     *
+     * @param[in,out] channel
+     *     This is the channel for which to prepare the next question.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
      */
-    double roundTime = 15.0;
+    void PrepareNextQuestion(
+        Channel& channel,
+        double now
+    ) {
+        TraceSpan span(tracer, "PrepareNextQuestion");
+        const auto level = channel.difficulty.GetLevel();
+        const auto maxFactor = 4 + 2 * level;
+        const auto maxAddend = 17 + 20 * level;
+        std::string expression;
+        AnswerValue questionAnswer;
+        size_t attempts = 0;
+        do {
+            if (attempts++ == MAX_QUESTION_ATTEMPTS) {
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    2, "Skipped a question in %s; no unused answers found",
+                    channel.name.c_str()
+                );
+                channel.nextQuestionTime = std::max(channel.nextQuestionTime, now);
+                UpdateNextQuestionTime(channel);
+                return;
+            }
+            std::vector< int > questionComponents(3);
+            questionComponents[0] = std::uniform_int_distribution<>(2, maxFactor)(generator);
+            questionComponents[1] = std::uniform_int_distribution<>(2, maxFactor)(generator);
+            questionComponents[2] = std::uniform_int_distribution<>(2, maxAddend)(generator);
+            expression = StringExtensions::sprintf(
+                "%d * %d + %d",
+                questionComponents[0],
+                questionComponents[1],
+                questionComponents[2]
+            );
+            (void)EvaluateAnswer(expression, AnswerSyntax::Expression, questionAnswer);
+        } while (
+            (questionAnswer == channel.lastAnswer)
+            || (channel.openAnswers.find(questionAnswer) != channel.openAnswers.end())
+        );
+        channel.preparedExpression = expression;
+        channel.preparedAnswer = questionAnswer;
+        channel.lastAnswer = questionAnswer;
+        channel.nextQuestionTime = std::max(channel.nextQuestionTime, now);
+        channel.preparedQuestionTime = channel.nextQuestionTime;
+        channel.questionPrepared = true;
+        ++channel.preparedQuestionGeneration;
+        UpdateNextQuestionTime(channel);
+        senderWakeCondition.notify_all();
+    }
 
     /**
-     * This is the correct answer to the current math question.
+     * This method starts a new question/answer round in the given
+     * channel, using the question which was just sent, and schedules
+     * the round to be scored.
+     *
+     * @param[in,out] channel
+     *     This is the channel in which to start a new round.
+     *
+     * @param[in] sentTime
+     *     This is the time (according to the time keeper) when
+     *     the question was sent.
      */
-    std::string answer;
+    void StartNewRound(
+        Channel& channel,
+        double sentTime
+    ) {
+        const auto roundId = channel.nextRoundId++;
+        auto& round = channel.rounds[roundId];
+        round.id = roundId;
+        round.expression = std::move(channel.preparedExpression);
+        round.answer = channel.preparedAnswer;
+        round.scheduledTime = channel.preparedQuestionTime;
+        round.sentTime = sentTime;
+        round.scoringTime = sentTime + roundTime;
+        channel.openAnswers[round.answer] = &round;
+        tracer.AsyncBegin("round", GetRoundTraceId(channel, roundId));
+        if (sentTime - channel.preparedQuestionTime > DEADLINE_MISS_TOLERANCE) {
+            ++channel.deadlineMisses;
+        }
+        ScheduleDeadline(
+            round.scoringTime,
+            DeadlineKind::ScoreRound,
+            channel,
+            roundId
+        );
+    }
 
     /**
-     * These are the users who are currently interacting with the bot.
+     * This method updates the scores of all users who participated
+     * in the given round in the given channel, and returns a string which
+     * describes who lost, which is intended to be included in the results
+     * message sent to the channel.
+     *
+     * @param[in,out] channel
+     *     This is the channel in which the round was played.
+     *
+     * @param[in] round
+     *     This is the round to score.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
+     *
+     * @return
+     *     A string which describes who lost,
+     *     which is intended to be included in the results
+     *     message sent to the channel, is returned.
      */
-    std::map< std::string, Contestant > contestants;
+    std::string ApplyScoresAndGetLosers(
+        Channel& channel,
+        const Round& round,
+        double now
+    ) {
+        auto& contestants = channel.contestants;
+        std::ostringstream buffer;
+        bool firstLoser = true;
+        for (const auto& pointDeltasEntry: round.pointDeltas) {
+            const auto nicknameId = pointDeltasEntry.first;
+            const auto pointDelta = pointDeltasEntry.second;
+            contestants[nicknameId].points += pointDelta;
+            channel.scoreWindows.AddPoints(nicknameId, pointDelta, now);
+            if (nicknameId != round.winner) {
+                if (firstLoser) {
+                    firstLoser = false;
+                } else {
+                    buffer << ", ";
+                }
+                buffer
+                    << nicknames.GetString(nicknameId) << " ("
+                    << pointDelta << " -> "
+                    << contestants[nicknameId].points << ")";
+            }
+        }
+        return buffer.str();
+    }
 
     /**
-     * These are the nicknames of the users who participated in answering
-     * the last question.
+     * This method scores the given round in the given channel,
+     * sends the results to the channel, and makes room for another
+     * question to be asked.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose round to score.
+     *
+     * @param[in] roundId
+     *     This is the ID of the round to score.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
      */
-    std::set< std::string > nicknamesOfParticipantsThisRound;
+    void ScoreRound(
+        Channel& channel,
+        unsigned int roundId,
+        double now
+    ) {
+        const auto roundsEntry = channel.rounds.find(roundId);
+        if (roundsEntry == channel.rounds.end()) {
+            return;
+        }
+        TraceSpan span(tracer, "ScoreRound");
+        const auto round = std::move(roundsEntry->second);
+        channel.openAnswers.erase(round.answer);
+        channel.rounds.erase(roundsEntry);
+        const auto scoringDelay = now - round.scoringTime;
+        if (scoringDelay > DEADLINE_MISS_TOLERANCE) {
+            ++channel.deadlineMisses;
+        }
+        diagnosticsSender.SendDiagnosticInformationFormatted(
+            2, "Round timing in %s: question sent %.0f ms late, scored %.0f ms late; queue depth peak %zu, %zu dropped, %zu deadlines missed",
+            channel.name.c_str(),
+            (round.sentTime - round.scheduledTime) * 1000.0,
+            scoringDelay * 1000.0,
+            channel.peakQueueDepth,
+            channel.messagesDropped,
+            channel.deadlineMisses
+        );
+        channel.peakQueueDepth = channel.inboundCount;
+        channel.messagesDropped = 0;
+        const auto solved = (round.winner != StringInterner::NOT_FOUND);
+        channel.difficulty.RecordRound(
+            solved,
+            solved ? round.timeToCorrect : roundTime,
+            round.answers,
+            round.wrongAnswers
+        );
+        diagnosticsSender.SendDiagnosticInformationFormatted(
+            2, "Difficulty in %s is now level %d",
+            channel.name.c_str(),
+            channel.difficulty.GetLevel()
+        );
+        const auto losersList = ApplyScoresAndGetLosers(channel, round, now);
+        std::ostringstream buffer;
+        if (
+            (maxOpenQuestions > 1)
+            && !round.expression.empty()
+        ) {
+            buffer << round.expression << " = " << round.answer.ToString() << ": ";
+        }
+        if (!solved) {
+            buffer << "No winners this round";
+            if (!losersList.empty()) {
+                buffer << ", only losers BibleThump " << losersList;
+            }
+        } else {
+            const auto points = channel.contestants[round.winner].points;
+            buffer
+                << "Congratulations, " << nicknames.GetString(round.winner) << "! (now at "
+                << points << " point"
+                << ((points == 1) ? "" : "s")
+                << ")";
+            if (!losersList.empty()) {
+                buffer << " FeelsBadMan " << losersList;
+            }
+        }
+        buffer << ".";
+        if (round.winningMsgId.empty()) {
+            TraceSpan sendSpan(tracer, "SendMessage");
+            tmi.SendMessage(
+                channel.name,
+                buffer.str()
+            );
+        } else {
+            TraceSpan sendSpan(tracer, "SendResponse");
+            tmi.SendResponse(
+                channel.name,
+                buffer.str(),
+                round.winningMsgId
+            );
+        }
+        tracer.AsyncEnd("round", GetRoundTraceId(channel, roundId));
+        ScheduleDeadline(now, DeadlineKind::PrepareQuestion, channel);
+    }
 
     /**
-     * This is the nickname of the user who won the last round.
+     * This method prepares questions and scores rounds in any
+     * channels where it's time to do so.
      */
-    std::string winnerThisRound;
+    void ServeDeadlines() {
+        const auto now = timeKeeper->GetCurrentTime();
+        while (
+            !deadlines.empty()
+            && (deadlines.top().time <= now)
+        ) {
+            const auto deadline = deadlines.top();
+            deadlines.pop();
+            auto& channel = *deadline.channel;
+            if (!channel.joined) {
+                continue;
+            }
+            switch (deadline.kind) {
+                case DeadlineKind::PrepareQuestion: {
+                    if (
+                        !channel.questionPrepared
+                        && (now >= channel.nextQuestionTime - QUESTION_PREPARATION_LEAD)
+                        && (channel.rounds.size() < maxOpenQuestions)
+                    ) {
+                        PrepareNextQuestion(channel, now);
+                    }
+                } break;
+
+                case DeadlineKind::ScoreRound: {
+                    ScoreRound(channel, deadline.roundId, now);
+                } break;
+
+                default: {
+                } break;
+            }
+        }
+    }
 
     /**
-     * If there is a user who won the last round, this is the `id`
-     * of the message they sent containing the winning answer.
+     * This method handles messages waiting in the channel queues,
+     * using deficit round-robin so that every channel with messages
+     * waiting gets its turn, regardless of how many messages any
+     * other channel has waiting.  Deadlines are served between turns,
+     * so that a busy channel can't hold up questions or scoring
+     * in any channel.
+     *
+     * @param[in,out] lock
+     *     This is the lock on the object's mutex, which is released
+     *     between turns to let new messages be queued.
      */
-    std::string winningMsgId;
+    void HandleQueuedMessages(std::unique_lock< decltype(mutex) >& lock) {
+        auto turnsLeft = channelsWithMessages.size();
+        while (
+            !stopWorker
+            && (turnsLeft > 0)
+            && !channelsWithMessages.empty()
+        ) {
+            --turnsLeft;
+            auto& channel = *channelsWithMessages.front();
+            channelsWithMessages.pop_front();
+            channel.deficit += MESSAGE_QUANTUM;
+            tracer.Begin("HandleQueuedMessages");
+            while (
+                (channel.deficit > 0)
+                && (channel.inboundCount > 0)
+            ) {
+                const auto message = PopInbound(channel);
+                --channel.deficit;
+                if (
+                    !IfMessageIsLeaderboardRequestThenHandleIt(
+                        channel,
+                        message->content,
+                        message->msgId,
+                        message->receivedTime
+                    )
+                ) {
+                    IfMessageIsAnswerThenHandleIt(
+                        channel,
+                        message->nickname,
+                        message->nicknameLength,
+                        message->content,
+                        message->msgId,
+                        message->receivedTime
+                    );
+                }
+                messagePool.Release(message);
+            }
+            if (channel.inboundCount == 0) {
+                channel.deficit = 0;
+            } else {
+                channelsWithMessages.push_back(&channel);
+            }
+            tracer.End("HandleQueuedMessages");
+            ServeDeadlines();
+            lock.unlock();
+            TraceSpan lockSpan(tracer, "lock");
+            lock.lock();
+        }
+    }
 
-    // Methods
+    /**
+     * This method takes a batch of messages from the inbound queue,
+     * drops any which are duplicates or aren't for a channel the bot
+     * is in, and queues the rest on their channels.
+     */
+    void TakeInboundMessages() {
+        if (
+            inboundQueue.IsEmpty()
+            && (inboundMessagesDropped == 0)
+        ) {
+            return;
+        }
+        TraceSpan span(tracer, "TakeInboundMessages");
+        PooledMessage* message;
+        for (
+            size_t i = 0;
+            (i < INBOUND_BATCH_SIZE) && inboundQueue.TryPop(message);
+            ++i
+        ) {
+            const auto channelId = channelNames.Find(
+                message->channel,
+                message->channelLength
+            );
+            if (
+                (channelId == StringInterner::NOT_FOUND)
+                || (channelId >= channelsById.size())
+                || !channelsById[channelId]->joined
+            ) {
+                messagePool.Release(message);
+                continue;
+            }
+            if (
+                !message->msgId.empty()
+                && messageIdFilter.IsDuplicate(message->msgId, message->receivedTime)
+            ) {
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    1, "Ignoring duplicate message %s",
+                    message->msgId.c_str()
+                );
+                messagePool.Release(message);
+                continue;
+            }
+            auto& channel = *channelsById[channelId];
+            const auto wasEmpty = (channel.inboundCount == 0);
+            if (!PushInbound(channel, message)) {
+                ++channel.messagesDropped;
+                messagePool.Release(message);
+                continue;
+            }
+            if (wasEmpty) {
+                channelsWithMessages.push_back(&channel);
+            }
+            channel.peakQueueDepth = std::max(channel.peakQueueDepth, channel.inboundCount);
+        }
+        const auto dropped = inboundMessagesDropped.exchange(0);
+        if (dropped > 0) {
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                "Inbound message queue full; %zu messages dropped",
+                dropped
+            );
+        }
+    }
 
     /**
-     * This is the default constructor.
+     * This function is called in a separate thread to have the bot
+     * take action at certain points in time, and to handle
+     * messages received.
      */
-    Impl()
-        : diagnosticsSender("MathBot2001")
-    {
+    void Worker() {
+        tracer.NameThread("worker");
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        while (!stopWorker) {
+            auto timeout = std::chrono::duration< double >(
+                std::chrono::milliseconds(WORKER_POLLING_PERIOD_MILLISECONDS)
+            );
+            if (!deadlines.empty()) {
+                timeout = std::min(
+                    timeout,
+                    std::chrono::duration< double >(
+                        std::max(
+                            deadlines.top().time - timeKeeper->GetCurrentTime(),
+                            0.0
+                        )
+                    )
+                );
+            }
+            workerWakeCondition.wait_for(
+                lock,
+                timeout,
+                [this]{
+                    return (
+                        stopWorker
+                        || !channelsWithMessages.empty()
+                        || !inboundQueue.IsEmpty()
+                    );
+                }
+            );
+            TakeInboundMessages();
+            ServeDeadlines();
+            HandleQueuedMessages(lock);
+        }
     }
 
     /**
-     * This method updates the times of when the current question
-     * will be scored, and the next question asked.
+     * This function is called in a separate thread to send each
+     * prepared math question at the time it's scheduled to be asked,
+     * and to start the round once the question has gone out.
      */
-    void UpdateRoundTimes() {
-        currentScoringTime = nextQuestionTime + roundTime;
-        nextQuestionTime += std::uniform_real_distribution<>(
-            minQuestionCooldown,
-            maxQuestionCooldown
-        )(generator);
+    void Sender() {
+        tracer.NameThread("sender");
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        while (!stopWorker) {
+            Channel* nextChannel = nullptr;
+            for (auto& channelsEntry: channels) {
+                auto& channel = channelsEntry.second;
+                if (
+                    channel.questionPrepared
+                    && (
+                        (nextChannel == nullptr)
+                        || (channel.preparedQuestionTime < nextChannel->preparedQuestionTime)
+                    )
+                ) {
+                    nextChannel = &channel;
+                }
+            }
+            if (nextChannel == nullptr) {
+                senderWakeCondition.wait(lock);
+                continue;
+            }
+            const auto delay = nextChannel->preparedQuestionTime - timeKeeper->GetCurrentTime();
+            if (delay > 0.0) {
+                senderWakeCondition.wait_for(
+                    lock,
+                    std::chrono::duration< double >(delay)
+                );
+                continue;
+            }
+            const auto channelName = nextChannel->name;
+            const auto question = "What is " + nextChannel->preparedExpression + "?";
+            const auto generation = nextChannel->preparedQuestionGeneration;
+            lock.unlock();
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1, "Asking in %s: %s",
+                channelName.c_str(),
+                question.c_str()
+            );
+            tracer.Begin("SendMessage");
+            tmi.SendMessage(channelName, question);
+            tracer.End("SendMessage");
+            const auto sentTime = timeKeeper->GetCurrentTime();
+            tracer.Begin("lock");
+            lock.lock();
+            tracer.End("lock");
+            if (
+                !nextChannel->joined
+                || !nextChannel->questionPrepared
+                || (nextChannel->preparedQuestionGeneration != generation)
+            ) {
+                // The channel was left while the question was being
+                // sent, so the question may not be the one now prepared
+                // (if any), and no round should be started for it.
+                continue;
+            }
+            StartNewRound(*nextChannel, sentTime);
+            nextChannel->questionPrepared = false;
+            ScheduleDeadline(
+                nextChannel->nextQuestionTime - QUESTION_PREPARATION_LEAD,
+                DeadlineKind::PrepareQuestion,
+                *nextChannel
+            );
+            workerWakeCondition.notify_all();
+        }
     }
 
-   /**
-     * This is method starts the worker thread if it isn't running.
+    /**
+     * This method is called to check if a tell sent by a user
+     * is a request for a leaderboard ("!top", optionally followed by
+     * "day", "week", or "season").  If it is, the contestants who
+     * gained the most points within the requested window (the last
+     * 24 hours, if none is given) are sent in response, unless
+     * a leaderboard was sent to the channel too recently.  Contestants
+     * who gained no points overall within the window are left out.
+     *
+     * @param[in,out] channel
+     *     This is the channel in which the tell was sent.
+     *
+     * @param[in] tell
+     *     This is the content of the user's tell.
+     *
+     * @param[in] msgId
+     *     This is the `id` field of the user's tell.
+     *
+     * @param[in] receivedTime
+     *     This is the time (according to the time keeper) when
+     *     the user's tell was received.
+     *
+     * @return
+     *     An indication of whether or not the tell was a request
+     *     for a leaderboard is returned.
      */
-    void StartWorker() {
-        if (workerThread.joinable()) {
-            return;
+    bool IfMessageIsLeaderboardRequestThenHandleIt(
+        Channel& channel,
+        const std::string& tell,
+        const std::string& msgId,
+        double receivedTime
+    ) {
+        if (tell.compare(0, 4, "!top") != 0) {
+            return false;
+        }
+        const auto request = StringExtensions::ToLower(
+            StringExtensions::Trim(tell.substr(4))
+        );
+        ScoreWindow window;
+        std::string windowDescription;
+        if (
+            request.empty()
+            || (request == "day")
+        ) {
+            window = ScoreWindow::Day;
+            windowDescription = "in the last 24h";
+        } else if (request == "week") {
+            window = ScoreWindow::Week;
+            windowDescription = "in the last 7 days";
+        } else if (request == "season") {
+            window = ScoreWindow::Season;
+            windowDescription = "this season";
+        } else {
+            return false;
+        }
+        if (receivedTime - channel.lastLeaderboardTime < LEADERBOARD_COOLDOWN) {
+            return true;
+        }
+        channel.lastLeaderboardTime = receivedTime;
+        const auto standings = channel.scoreWindows.GetTop(
+            window,
+            LEADERBOARD_SIZE,
+            timeKeeper->GetCurrentTime()
+        );
+        size_t numStandings = 0;
+        while (
+            (numStandings < standings.size())
+            && (standings[numStandings].points > 0)
+        ) {
+            ++numStandings;
         }
-        stopWorker = false;
-        generator.seed((int)time(NULL));
-        nextQuestionTime = timeKeeper->GetCurrentTime();
-        workerThread = std::thread(&Impl::Worker, this);
+        std::ostringstream buffer;
+        if (numStandings == 0) {
+            buffer << "No one has gained points " << windowDescription << ".";
+        } else {
+            buffer << "Top scores " << windowDescription << ": ";
+            for (size_t i = 0; i < numStandings; ++i) {
+                if (i > 0) {
+                    buffer << ", ";
+                }
+                buffer
+                    << (i + 1) << ". " << nicknames.GetString(standings[i].nicknameId)
+                    << " (" << standings[i].points << ")";
+            }
+            buffer << ".";
+        }
+        TraceSpan sendSpan(tracer, "SendResponse");
+        tmi.SendResponse(
+            channel.name,
+            buffer.str(),
+            msgId
+        );
+        return true;
     }
 
     /**
-     * This method stops the worker thread if it's running.
+     * This method is called to check if a tell sent by a user
+     * appears to be an attempt to answer an open question.  If it is,
+     * the answer is looked up among the answers to the open questions.
+     * If it matches one, the user is awarded a point in that question's
+     * round.  Otherwise, the user is penalized a point in the round
+     * of the question most recently asked.  Any tell which is a single
+     * number counts as an answer, and is compared by value, so that
+     * "42", "042", "42.0" and "84/2" are all the same answer.
+     *
+     * @param[in,out] channel
+     *     This is the channel in which the tell was sent.
+     *
+     * @param[in] userNickname
+     *     This points to the characters of the nickname of the user
+     *     who sent the tell.
+     *
+     * @param[in] userNicknameLength
+     *     This is the number of characters in the user's nickname.
+     *
+     * @param[in] tell
+     *     This is the content of the user's tell.
+     *
+     * @param[in] msgId
+     *     This is the `id` field of the user's tell.
+     *
+     * @param[in] receivedTime
+     *     This is the time (according to the time keeper) when
+     *     the user's tell was received.
+     *
+     * @note
+     *     Once a question has been answered correctly, any further
+     *     answers which match it, or which would be charged to its
+     *     round, are ignored.
      */
-    void StopWorker() {
-        if (!workerThread.joinable()) {
+    void IfMessageIsAnswerThenHandleIt(
+        Channel& channel,
+        const char* userNickname,
+        size_t userNicknameLength,
+        const std::string& tell,
+        const std::string& msgId,
+        double receivedTime
+    ) {
+        AnswerValue tellValue;
+        if (!EvaluateAnswer(tell, AnswerSyntax::Number, tellValue)) {
             return;
         }
-        {
-            std::lock_guard< decltype(mutex) > lock(mutex);
-            stopWorker = true;
-            workerWakeCondition.notify_all();
+        const auto openAnswersEntry = channel.openAnswers.find(tellValue);
+        const auto correct = (openAnswersEntry != channel.openAnswers.end());
+        Round* round;
+        if (correct) {
+            round = openAnswersEntry->second;
+        } else if (channel.rounds.empty()) {
+            return;
+        } else {
+            round = &channel.rounds.rbegin()->second;
+        }
+        if (round->complete) {
+            return;
+        }
+        const auto userNicknameId = nicknames.Intern(userNickname, userNicknameLength);
+        (void)channel.contestants[userNicknameId];
+        auto& pointDelta = round->pointDeltas[userNicknameId];
+        ++round->answers;
+        if (round->answers == 1) {
+            tracer.AsyncStep("round", "first answer", GetRoundTraceId(channel, round->id));
+        }
+        if (correct) {
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1, "Winner: %.*s",
+                (int)userNicknameLength, userNickname
+            );
+            round->winner = userNicknameId;
+            round->winningMsgId = msgId;
+            round->complete = true;
+            round->timeToCorrect = receivedTime - round->sentTime;
+            tracer.AsyncStep("round", "answered", GetRoundTraceId(channel, round->id));
+            ++pointDelta;
+        } else {
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1, "Loser: %.*s",
+                (int)userNicknameLength, userNickname
+            );
+            ++round->wrongAnswers;
+            --pointDelta;
         }
-        workerThread.join();
     }
 
     /**
-     * This method clears any information about the last round,
-     * and starts a new question/answer round.
+     * This method changes the points of the given contestants.
+     * The object's mutex must be locked by the caller.
      *
-     * @return
-     *     The next question is returned.
-     */
-    std::string StartNewRound() {
-        const auto lastAnswer = answer;
-        nicknamesOfParticipantsThisRound.clear();
-        winnerThisRound.clear();
-        winningMsgId.clear();
-        std::string question;
-        do {
-            std::vector< int > questionComponents(3);
-            questionComponents[0] = std::uniform_int_distribution<>(2, 10)(generator);
-            questionComponents[1] = std::uniform_int_distribution<>(2, 10)(generator);
-            questionComponents[2] = std::uniform_int_distribution<>(2, 97)(generator);
-            question = StringExtensions::sprintf(
-                "What is %d * %d + %d?",
-                questionComponents[0],
-                questionComponents[1],
-                questionComponents[2]
-            );
-            answer = StringExtensions::sprintf(
-                "%d",
-                questionComponents[0] * questionComponents[1] + questionComponents[2]
+     * @param[in] deltas
+     *     This points to the changes to make to contestants' points.
+     *
+     * @param[in] numDeltas
+     *     This is the number of changes to make.
+     */
+    void ApplyScoreDeltas(
+        const MathBot2001::ScoreDelta* deltas,
+        size_t numDeltas
+    ) {
+        Channel* channel = nullptr;
+        bool channelsAdded = false;
+        for (size_t i = 0; i < numDeltas; ++i) {
+            const auto& delta = deltas[i];
+            if (
+                (channel == nullptr)
+                || (delta.channel != channel->name)
+            ) {
+                const auto key = StringExtensions::ToLower(delta.channel);
+                const auto channelsEntry = channels.find(key);
+                if (channelsEntry == channels.end()) {
+                    channel = &channels[key];
+                    channel->name = delta.channel;
+                    channelsAdded = true;
+                } else {
+                    channel = &channelsEntry->second;
+                }
+            }
+            auto& contestant = channel->contestants[nicknames.Intern(delta.nickname)];
+            contestant.points = (int)std::min(
+                std::max(
+                    (intmax_t)contestant.points + delta.delta,
+                    (intmax_t)std::numeric_limits< int >::min()
+                ),
+                (intmax_t)std::numeric_limits< int >::max()
             );
-        } while (answer == lastAnswer);
-        roundScored = false;
-        roundComplete = false;
-        UpdateRoundTimes();
-        return question;
+        }
+        if (channelsAdded) {
+            IndexChannels();
+        }
     }
 
     /**
-     * This method updates the scores of all users who participated
-     * this round, and returns a string which describes who lost,
-     * which is intended to be included in the results
-     * message sent to the channel.
+     * This method writes the state of the game (the generator,
+     * and the schedule, open rounds, and contestants
+     * of every channel) to the given stream.
      *
-     * @return
-     *     A string which describes who lost,
-     *     which is intended to be included in the results
-     *     message sent to the channel, is returned.
+     * @param[in,out] stream
+     *     This is the stream to which to write the snapshot.
      */
-    std::string ApplyScoresAndGetLosers() {
-        std::ostringstream buffer;
-        bool firstLoser = true;
-        for (const auto& nickname: nicknamesOfParticipantsThisRound) {
-            contestants[nickname].points += contestants[nickname].pointDelta;
-            if (nickname != winnerThisRound) {
-                if (firstLoser) {
-                    firstLoser = false;
-                } else {
-                    buffer << ", ";
-                }
-                buffer
-                    << nickname << " ("
-                    << contestants[nickname].pointDelta << " -> "
-                    << contestants[nickname].points << ")";
+    void WriteSnapshot(std::ostream& stream) {
+        stream.precision(std::numeric_limits< double >::max_digits10);
+        stream << SNAPSHOT_HEADER << SNAPSHOT_VERSION << '\n' << generator << '\n' << channels.size() << '\n';
+        for (const auto& channelsEntry: channels) {
+            const auto& channel = channelsEntry.second;
+            WriteSnapshotString(stream, channel.name);
+            stream
+                << ' ' << (
+                    channel.questionPrepared
+                    ? channel.preparedQuestionTime
+                    : channel.nextQuestionTime
+                )
+                << ' ';
+            WriteSnapshotString(stream, channel.lastAnswer.ToString());
+            stream << ' ';
+            channel.difficulty.WriteState(stream);
+            stream << '\n' << channel.rounds.size() << '\n';
+            for (const auto& roundsEntry: channel.rounds) {
+                WriteSnapshotRound(stream, roundsEntry.second, nicknames);
+                stream << '\n';
+            }
+            stream << channel.contestants.size() << '\n';
+            for (const auto& contestantsEntry: channel.contestants) {
+                const auto& contestant = contestantsEntry.second;
+                WriteSnapshotString(stream, nicknames.GetString(contestantsEntry.first));
+                stream
+                    << ' ' << contestant.points
+                    << '\n';
             }
+            channel.scoreWindows.WriteState(stream, nicknames);
+            stream << '\n';
         }
-        return buffer.str();
     }
 
     /**
-     * This function is called in a separate thread to have the bot
-     * take action at certain points in time.
+     * This method reads the schedule and current round of a channel
+     * from a snapshot written in version 1 or 2 of the snapshot format,
+     * in which a channel had at most one round at a time, and each
+     * contestant's points gained or lost in that round were stored
+     * with the contestant.  A channel which had not yet been asked
+     * a question has an empty answer, and is restored with no
+     * open round.
+     *
+     * @param[in,out] stream
+     *     This is the stream from which to read the snapshot.
+     *
+     * @param[in] version
+     *     This is the version of the snapshot format.
+     *
+     * @param[in,out] channel
+     *     This is the channel whose state to read.
+     *
+     * @return
+     *     An indication of whether or not the channel's state was read
+     *     is returned.
      */
-    void Worker() {
-        std::unique_lock< decltype(mutex) > lock(mutex);
-        while (!stopWorker) {
-            workerWakeCondition.wait_for(
-                lock,
-                std::chrono::milliseconds(WORKER_POLLING_PERIOD_MILLISECONDS),
-                [this]{ return stopWorker; }
-            );
-            const auto now = timeKeeper->GetCurrentTime();
-            if (now >= nextQuestionTime) {
-                const auto question = StartNewRound();
-                lock.unlock();
-                tmi.SendMessage(channel, question);
-                lock.lock();
-            } else if (
-                (now >= currentScoringTime)
-                && !roundScored
+    bool ReadLegacySnapshotChannel(
+        std::istream& stream,
+        intmax_t version,
+        Channel& channel
+    ) {
+        Round round;
+        bool roundComplete, roundScored;
+        std::string answer, winner;
+        size_t numParticipants;
+        if (
+            !(
+                stream
+                >> channel.nextQuestionTime
+                >> roundComplete
+                >> roundScored
+                >> round.scoringTime
+                >> round.scheduledTime
+                >> round.sentTime
+            )
+            || !ReadSnapshotString(stream >> std::ws, answer)
+            || (
+                !answer.empty()
+                && !EvaluateAnswer(answer, AnswerSyntax::Number, round.answer)
+            )
+            || !ReadSnapshotString(stream >> std::ws, winner)
+            || !ReadSnapshotString(stream >> std::ws, round.winningMsgId)
+            || (
+                (version >= 2)
+                && !channel.difficulty.ReadState(stream)
+            )
+            || !(stream >> numParticipants)
+        ) {
+            return false;
+        }
+        round.complete = roundComplete;
+        if (!winner.empty()) {
+            round.winner = nicknames.Intern(winner);
+        }
+        channel.lastAnswer = round.answer;
+        for (size_t i = 0; i < numParticipants; ++i) {
+            std::string participant;
+            if (!ReadSnapshotString(stream >> std::ws, participant)) {
+                return false;
+            }
+            round.pointDeltas[nicknames.Intern(participant)] = 0;
+        }
+        size_t numContestants;
+        if (!(stream >> numContestants)) {
+            return false;
+        }
+        for (size_t i = 0; i < numContestants; ++i) {
+            std::string nickname;
+            Contestant contestant;
+            int pointDelta;
+            if (
+                !ReadSnapshotString(stream >> std::ws, nickname)
+                || !(stream >> contestant.points >> pointDelta)
             ) {
-                roundComplete = true;
-                roundScored = true;
-                const auto losersList = ApplyScoresAndGetLosers();
-                std::ostringstream buffer;
-                if (winnerThisRound.empty()) {
-                    buffer << "No winners this round";
-                    if (!losersList.empty()) {
-                        buffer << ", only losers BibleThump " << losersList;
-                    }
-                } else {
-                    buffer
-                        << "Congratulations, " << winnerThisRound << "! (now at "
-                        << contestants[winnerThisRound].points << " point"
-                        << ((contestants[winnerThisRound].points == 1) ? "" : "s")
-                        << ")";
-                    if (!losersList.empty()) {
-                        buffer << " FeelsBadMan " << losersList;
-                    }
-                }
-                buffer << ".";
-                if (winningMsgId.empty()) {
-                    tmi.SendMessage(
-                        channel,
-                        buffer.str()
-                    );
-                } else {
-                    tmi.SendResponse(
-                        channel,
-                        buffer.str(),
-                        winningMsgId
-                    );
-                }
+                return false;
             }
+            const auto nicknameId = nicknames.Intern(nickname);
+            const auto pointDeltasEntry = round.pointDeltas.find(nicknameId);
+            if (pointDeltasEntry != round.pointDeltas.end()) {
+                pointDeltasEntry->second = pointDelta;
+            }
+            channel.contestants[nicknameId] = contestant;
+        }
+        if (
+            !roundScored
+            && !answer.empty()
+        ) {
+            round.id = channel.nextRoundId++;
+            channel.rounds[round.id] = std::move(round);
         }
+        return true;
     }
 
     /**
-     * This method is called to check if a tell sent by a user
-     * appears to be an attempt to answer the last question.  If it is,
-     * the answer is checked for accuracy, and the user is either awarded
-     * a point or penalized a point.
+     * This method reads the schedule, open rounds, and contestants
+     * of a channel from a snapshot written by WriteSnapshot.
      *
-     * @param[in] userNickname
-     *     This is the nickname of the user who sent the tell.
+     * @param[in,out] stream
+     *     This is the stream from which to read the snapshot.
      *
-     * @param[in] tell
-     *     This is the content of the user's tell.
+     * @param[in] version
+     *     This is the version of the snapshot format.
      *
-     * @param[in] msgId
-     *     This is the `id` field of the user's tell.
+     * @param[in,out] channel
+     *     This is the channel whose state to read.
      *
-     * @note
-     *     If the last question was already answered correctly, any
-     *     subsequent answers are ignored, until the next question is asked.
+     * @return
+     *     An indication of whether or not the channel's state was read
+     *     is returned.
      */
-    void IfMessageIsAnswerThenHandleIt(
-        const std::string& userNickname,
-        const std::string& tell,
-        const std::string& msgId
+    bool ReadSnapshotChannel(
+        std::istream& stream,
+        intmax_t version,
+        Channel& channel
     ) {
-        intmax_t tellAsNumber;
+        std::string lastAnswer;
+        size_t numRounds;
         if (
-            StringExtensions::ToInteger(tell, tellAsNumber)
-            != StringExtensions::ToIntegerResult::Success
+            !(stream >> channel.nextQuestionTime)
+            || !ReadSnapshotString(stream >> std::ws, lastAnswer)
+            || !EvaluateAnswer(lastAnswer, AnswerSyntax::Number, channel.lastAnswer)
+            || !channel.difficulty.ReadState(stream)
+            || !(stream >> numRounds)
         ) {
-            return;
+            return false;
+        }
+        for (size_t i = 0; i < numRounds; ++i) {
+            Round round;
+            if (!ReadSnapshotRound(stream, round, nicknames)) {
+                return false;
+            }
+            round.id = channel.nextRoundId++;
+            channel.rounds[round.id] = std::move(round);
+        }
+        size_t numContestants;
+        if (!(stream >> numContestants)) {
+            return false;
+        }
+        for (size_t i = 0; i < numContestants; ++i) {
+            std::string nickname;
+            Contestant contestant;
+            if (
+                !ReadSnapshotString(stream >> std::ws, nickname)
+                || !(stream >> contestant.points)
+            ) {
+                return false;
+            }
+            channel.contestants[nicknames.Intern(nickname)] = contestant;
+        }
+        return (
+            (version < 4)
+            || channel.scoreWindows.ReadState(stream, nicknames)
+        );
+    }
+
+    /**
+     * This method restores the state of the game from a snapshot
+     * written by WriteSnapshot.
+     *
+     * @param[in,out] stream
+     *     This is the stream from which to read the snapshot.
+     *
+     * @return
+     *     An indication of whether or not the snapshot was valid and
+     *     the state of the game restored is returned.  If not,
+     *     the state of the game is unchanged.
+     */
+    bool ReadSnapshot(std::istream& stream) {
+        std::string header;
+        if (
+            !std::getline(stream, header)
+            || (header.substr(0, SNAPSHOT_HEADER.length()) != SNAPSHOT_HEADER)
+        ) {
+            return false;
+        }
+        intmax_t version;
+        if (
+            (
+                StringExtensions::ToInteger(header.substr(SNAPSHOT_HEADER.length()), version)
+                != StringExtensions::ToIntegerResult::Success
+            )
+            || (version < 1)
+            || (version > SNAPSHOT_VERSION)
+        ) {
+            return false;
+        }
+        std::mt19937 restoredGenerator;
+        size_t numChannels;
+        if (!(stream >> restoredGenerator >> numChannels)) {
+            return false;
+        }
+        std::map< std::string, Channel > restoredChannels;
+        for (size_t i = 0; i < numChannels; ++i) {
+            Channel channel;
+            if (
+                !ReadSnapshotString(stream >> std::ws, channel.name)
+                || !(
+                    (version >= 3)
+                    ? ReadSnapshotChannel(stream, version, channel)
+                    : ReadLegacySnapshotChannel(stream, version, channel)
+                )
+            ) {
+                return false;
+            }
+            const auto key = StringExtensions::ToLower(channel.name);
+            restoredChannels[key] = std::move(channel);
+        }
+        generator = restoredGenerator;
+        generatorSeeded = true;
+        for (auto& restoredChannelsEntry: restoredChannels) {
+            auto& channel = channels[restoredChannelsEntry.first];
+            channel = std::move(restoredChannelsEntry.second);
+            IndexOpenAnswers(channel);
         }
-        if (roundComplete) {
+        return true;
+    }
+
+    /**
+     * This method saves the state of the game to the snapshot file,
+     * if one was set up.  The snapshot is first written to a temporary
+     * file, which then replaces the snapshot file, so that a snapshot
+     * file is never left partially written.
+     */
+    void SaveSnapshot() {
+        if (snapshotPath.empty()) {
             return;
         }
-        auto& userEntry = contestants[userNickname];
-        if (nicknamesOfParticipantsThisRound.insert(userNickname).second) {
-            userEntry.pointDelta = 0;
-        }
-        userEntry.nickname = userNickname;
-        if (tell == answer) {
-            diagnosticsSender.SendDiagnosticInformationString(1, "Winner: " + userNickname);
-            winnerThisRound = userNickname;
-            winningMsgId = msgId;
-            roundComplete = true;
-            ++userEntry.pointDelta;
-        } else {
-            diagnosticsSender.SendDiagnosticInformationString(1, "Loser: " + userNickname);
-            --userEntry.pointDelta;
+        const auto temporaryPath = snapshotPath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                WriteSnapshot(file);
+            }
+            file.flush();
+            if (!file) {
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    "unable to write snapshot file '%s'",
+                    temporaryPath.c_str()
+                );
+                return;
+            }
+        }
+        if (rename(temporaryPath.c_str(), snapshotPath.c_str()) != 0) {
+            (void)remove(snapshotPath.c_str());
+            if (rename(temporaryPath.c_str(), snapshotPath.c_str()) != 0) {
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    "unable to replace snapshot file '%s'",
+                    snapshotPath.c_str()
+                );
+                return;
+            }
         }
+        diagnosticsSender.SendDiagnosticInformationString(2, "Snapshot saved.");
+    }
+
+    /**
+     * This method reports that writing the transcript has failed,
+     * unless this has already been reported.
+     */
+    void ReportTranscriptFailure() {
+        if (transcriptFailureReported) {
+            return;
+        }
+        transcriptFailureReported = true;
+        diagnosticsSender.SendDiagnosticInformationString(
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            "unable to write transcript file"
+        );
     }
 
     // Twitch::Messaging::User
 
     virtual void LogIn() override {
+        tracer.NameThread("Twitch");
         diagnosticsSender.SendDiagnosticInformationString(1, "Logged in.");
-        tmi.Join(channel);
+        std::vector< std::string > channelNames;
+        {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            for (const auto& channelsEntry: channels) {
+                if (channelsEntry.second.requested) {
+                    channelNames.push_back(channelsEntry.second.name);
+                }
+            }
+        }
+        for (const auto& channelName: channelNames) {
+            tmi.Join(channelName);
+        }
     }
 
     virtual void LogOut() override {
@@ -434,6 +2100,9 @@ struct MathBot2001::Impl
             return;
         }
         StopWorker();
+        if (!transcriptRecorder.Close()) {
+            ReportTranscriptFailure();
+        }
         diagnosticsSender.SendDiagnosticInformationString(1, "Logged out.");
         std::lock_guard< decltype(mutex) > lock(mutex);
         loggedOut = true;
@@ -443,15 +2112,84 @@ struct MathBot2001::Impl
     virtual void Join(
         Twitch::Messaging::MembershipInfo&& membershipInfo
     ) override {
-        if (membershipInfo.user == StringExtensions::ToLower(nickname)) {
-            StartWorker();
+        if (membershipInfo.user != StringExtensions::ToLower(nickname)) {
+            return;
+        }
+        {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            const auto channelsEntry = channels.find(
+                StringExtensions::ToLower(membershipInfo.channel)
+            );
+            if (
+                (channelsEntry == channels.end())
+                || !channelsEntry->second.requested
+            ) {
+                return;
+            }
+            auto& channel = channelsEntry->second;
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1, "Joined %s",
+                channel.name.c_str()
+            );
+            channel.joined = true;
+            if (channel.nextQuestionTime == std::numeric_limits< double >::max()) {
+                channel.nextQuestionTime = timeKeeper->GetCurrentTime();
+            }
+            channel.questionPrepared = false;
+            ScheduleDeadline(
+                channel.nextQuestionTime - QUESTION_PREPARATION_LEAD,
+                DeadlineKind::PrepareQuestion,
+                channel
+            );
+            for (const auto& roundsEntry: channel.rounds) {
+                ScheduleDeadline(
+                    roundsEntry.second.scoringTime,
+                    DeadlineKind::ScoreRound,
+                    channel,
+                    roundsEntry.first
+                );
+            }
         }
+        StartWorker();
     }
 
     virtual void Leave(
         Twitch::Messaging::MembershipInfo&& membershipInfo
     ) override {
-        if (membershipInfo.user == StringExtensions::ToLower(nickname)) {
+        if (membershipInfo.user != StringExtensions::ToLower(nickname)) {
+            return;
+        }
+        bool anyChannelsJoined = false;
+        {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            for (auto& channelsEntry: channels) {
+                auto& channel = channelsEntry.second;
+                if (channelsEntry.first == StringExtensions::ToLower(membershipInfo.channel)) {
+                    diagnosticsSender.SendDiagnosticInformationFormatted(
+                        1, "Left %s",
+                        channel.name.c_str()
+                    );
+                    channel.joined = false;
+                    channel.nextQuestionTime = std::numeric_limits< double >::max();
+                    channel.questionPrepared = false;
+                    channel.rounds.clear();
+                    channel.openAnswers.clear();
+                    while (channel.inboundCount > 0) {
+                        messagePool.Release(PopInbound(channel));
+                    }
+                    channelsWithMessages.erase(
+                        std::remove(
+                            channelsWithMessages.begin(),
+                            channelsWithMessages.end(),
+                            &channel
+                        ),
+                        channelsWithMessages.end()
+                    );
+                }
+                anyChannelsJoined = anyChannelsJoined || channel.joined;
+            }
+        }
+        if (!anyChannelsJoined) {
             StopWorker();
         }
     }
@@ -459,21 +2197,47 @@ struct MathBot2001::Impl
     virtual void Message(
         Twitch::Messaging::MessageInfo&& messageInfo
     ) override {
-        diagnosticsSender.SendDiagnosticInformationFormatted(
-            1, "%s said in channel \"%s\", \"%s\"",
-            messageInfo.user.c_str(),
-            messageInfo.channel.c_str(),
-            messageInfo.messageContent.c_str()
-        );
-        IfMessageIsAnswerThenHandleIt(
-            messageInfo.user,
-            messageInfo.messageContent,
-            messageInfo.tags.id
-        );
+        TraceSpan span(tracer, "Message");
+        // Inbound chat is not echoed as diagnostics here; it's kept
+        // by the transcript, if one is being recorded.
+        const auto receivedTime = timeKeeper->GetCurrentTime();
+        if (
+            !transcriptRecorder.Record(
+                receivedTime,
+                messageInfo.user,
+                messageInfo.channel,
+                messageInfo.tags.id,
+                messageInfo.messageContent
+            )
+        ) {
+            ReportTranscriptFailure();
+        }
+        // Only this thread acquires messages from the pool.
+        auto message = messagePool.Acquire();
+        if (message == nullptr) {
+            ++inboundMessagesDropped;
+            return;
+        }
+        if (!message->Assign(std::move(messageInfo), receivedTime)) {
+            messagePool.Release(message);
+            return;
+        }
+        // The worker thread is notified without locking the mutex,
+        // so this thread never waits on it.  If the notification is
+        // missed, the worker thread picks up the message the next
+        // time it polls.
+        if (inboundQueue.TryPush(std::move(message))) {
+            workerWakeCondition.notify_all();
+        } else {
+            messagePool.Release(message);
+            ++inboundMessagesDropped;
+        }
     }
 
 };
 
+constexpr size_t MathBot2001::MAX_OPEN_QUESTIONS;
+
 MathBot2001::~MathBot2001() noexcept = default;
 
 MathBot2001::MathBot2001()
@@ -532,18 +2296,171 @@ void MathBot2001::Configure(
     impl_->diagnosticsSender.SendDiagnosticInformationString(3, "Configured.");
 }
 
+void MathBot2001::SetConnectionFactory(
+    std::function< std::shared_ptr< Twitch::Connection >() > connectionFactory
+) {
+    impl_->tmi.SetConnectionFactory(connectionFactory);
+}
+
+bool MathBot2001::RecordTranscript(const std::string& path) {
+    return impl_->transcriptRecorder.Open(path);
+}
+
+bool MathBot2001::RecordTrace(const std::string& path) {
+    return impl_->tracer.Open(path);
+}
+
+void MathBot2001::ApplyScoreDeltas(const std::vector< ScoreDelta >& deltas) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->ApplyScoreDeltas(deltas.data(), deltas.size());
+}
+
+bool MathBot2001::ImportScores(
+    const std::string& path,
+    ScoreFileFormat format
+) {
+    ScoreFileReader reader;
+    if (!reader.Open(path, format)) {
+        return false;
+    }
+    std::vector< ScoreDelta > batch(SCORE_BATCH_SIZE);
+    size_t numImported = 0;
+    ScoreRecord record;
+    for (;;) {
+        size_t batchSize = 0;
+        while (
+            (batchSize < batch.size())
+            && reader.Next(record)
+        ) {
+            auto& delta = batch[batchSize++];
+            delta.channel.assign(record.channel);
+            delta.nickname.assign(record.nickname);
+            delta.delta = record.points;
+        }
+        if (batchSize > 0) {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            impl_->ApplyScoreDeltas(batch.data(), batchSize);
+        }
+        numImported += batchSize;
+        if (batchSize < batch.size()) {
+            break;
+        }
+    }
+    impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+        2, "Imported scores of %zu contestants.",
+        numImported
+    );
+    return !reader.Failed();
+}
+
+bool MathBot2001::ExportScores(
+    const std::string& path,
+    ScoreFileFormat format
+) {
+    ScoreFileWriter writer;
+    if (!writer.Open(path, format)) {
+        return false;
+    }
+    std::vector< Channel* > channels;
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        for (auto& channelsEntry: impl_->channels) {
+            channels.push_back(&channelsEntry.second);
+        }
+    }
+    std::vector< ScoreRecord > batch(SCORE_BATCH_SIZE);
+    size_t numExported = 0;
+    for (const auto channel: channels) {
+        bool firstBatch = true;
+        size_t lastNicknameId = 0;
+        for (;;) {
+            size_t batchSize = 0;
+            {
+                std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+                const auto& contestants = channel->contestants;
+                auto contestantsEntry = (
+                    firstBatch
+                    ? contestants.begin()
+                    : contestants.upper_bound(lastNicknameId)
+                );
+                while (
+                    (batchSize < batch.size())
+                    && (contestantsEntry != contestants.end())
+                ) {
+                    auto& record = batch[batchSize++];
+                    record.channel.assign(channel->name);
+                    record.nickname.assign(impl_->nicknames.GetString(contestantsEntry->first));
+                    record.points = contestantsEntry->second.points;
+                    lastNicknameId = contestantsEntry->first;
+                    ++contestantsEntry;
+                }
+            }
+            for (size_t i = 0; i < batchSize; ++i) {
+                writer.Write(batch[i]);
+            }
+            numExported += batchSize;
+            if (batchSize < batch.size()) {
+                break;
+            }
+            firstBatch = false;
+        }
+    }
+    impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+        2, "Exported scores of %zu contestants.",
+        numExported
+    );
+    return writer.Close();
+}
+
+bool MathBot2001::UseSnapshot(const std::string& path) {
+    impl_->snapshotPath = path;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return true;
+    }
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (!impl_->ReadSnapshot(file)) {
+        return false;
+    }
+    impl_->IndexChannels();
+    impl_->diagnosticsSender.SendDiagnosticInformationString(2, "Snapshot restored.");
+    return true;
+}
+
+void MathBot2001::SetMaxOpenQuestions(size_t maxOpenQuestions) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->maxOpenQuestions = std::min(
+        std::max(maxOpenQuestions, (size_t)1),
+        MAX_OPEN_QUESTIONS
+    );
+}
+
 void MathBot2001::InitiateLogIn(
     const std::string& token,
-    const std::string& channel,
+    const std::vector< std::string >& channels,
     const std::string& nickname
 ) {
-    impl_->channel = channel;
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        for (const auto& channelName: channels) {
+            auto& channel = impl_->channels[StringExtensions::ToLower(channelName)];
+            channel.name = channelName;
+            channel.requested = true;
+        }
+        impl_->IndexChannels();
+    }
     impl_->nickname = nickname;
     impl_->tmi.LogIn(impl_->nickname, token);
 }
 
 void MathBot2001::InitiateLogOut() {
     impl_->diagnosticsSender.SendDiagnosticInformationString(3, "Exiting...");
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->exiting = true;
+    }
+    impl_->StopWorker();
+    impl_->SaveSnapshot();
     impl_->tmi.LogOut("Bye! BibleThump");
 }
 
@@ -9,15 +9,44 @@
  * © 2018 by Richard Walters
  */
 
+#include "ScoreFile.hpp"
+
+#include <functional>
 #include <memory>
+#include <stddef.h>
 #include <string>
+#include <vector>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <Twitch/Connection.hpp>
 
 /**
  * This represents the chat bot itself.  It handles any callbacks
  * received from the Twitch messaging interface.
  */
 class MathBot2001 {
+    // Public Types
+public:
+    /**
+     * This is a change to be made to the points of one contestant.
+     */
+    struct ScoreDelta {
+        /**
+         * This is the channel in which the contestant has the points.
+         */
+        std::string channel;
+
+        /**
+         * This is the nickname of the contestant.
+         */
+        std::string nickname;
+
+        /**
+         * This is the number of points to add to the contestant's
+         * points, or (if negative) to take away from them.
+         */
+        int delta = 0;
+    };
+
     // Lifecycle Methods
 public:
     ~MathBot2001() noexcept;
@@ -44,26 +73,156 @@ public:
         SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
     );
 
+    /**
+     * This method replaces the function the bot uses to connect
+     * to Twitch chat.  It must be called after Configure,
+     * and is mainly used for testing.
+     *
+     * @param[in] connectionFactory
+     *     This is the function to call to make a new connection
+     *     to Twitch chat.
+     */
+    void SetConnectionFactory(
+        std::function< std::shared_ptr< Twitch::Connection >() > connectionFactory
+    );
+
+    /**
+     * This method starts recording every chat message the bot receives
+     * to the given transcript file.
+     *
+     * @param[in] path
+     *     This is the path of the transcript file to which to append.
+     *
+     * @return
+     *     An indication of whether or not the transcript file
+     *     was opened is returned.
+     */
+    bool RecordTranscript(const std::string& path);
+
+    /**
+     * This method starts recording a timeline of what the bot's threads
+     * do during each round to the given trace file, in the Chrome
+     * trace-event JSON format.
+     *
+     * @param[in] path
+     *     This is the path of the trace file to create.
+     *
+     * @return
+     *     An indication of whether or not the trace file
+     *     was created is returned.
+     */
+    bool RecordTrace(const std::string& path);
+
+    /**
+     * This method restores the state of the bot (scores, the open
+     * rounds and schedule of each channel, and the question generator)
+     * from the given snapshot file, if it exists, and arranges for
+     * the state of the bot to be saved back to the same file
+     * when logging out.
+     *
+     * @param[in] path
+     *     This is the path of the snapshot file to use.
+     *
+     * @return
+     *     An indication of whether or not the snapshot file either
+     *     does not exist, or was successfully restored, is returned.
+     *
+     * @note
+     *     This should be called before InitiateLogIn.
+     */
+    bool UseSnapshot(const std::string& path);
+
+    /**
+     * This method sets the largest number of questions which may be
+     * open (asked but not yet scored) at once in each channel.
+     * Questions are asked more often the more may be open at once.
+     *
+     * @param[in] maxOpenQuestions
+     *     This is the largest number of questions which may be open
+     *     at once in each channel.  It must be at least one, and is
+     *     clamped to MAX_OPEN_QUESTIONS.
+     *
+     * @note
+     *     This should be called before InitiateLogIn.
+     */
+    void SetMaxOpenQuestions(size_t maxOpenQuestions);
+
+    /**
+     * This method changes the points of the given contestants,
+     * all at once.  Contestants and channels which the bot doesn't
+     * know about yet are added.  Points which would go beyond the range
+     * of an int are clamped to that range.
+     *
+     * @param[in] deltas
+     *     These are the changes to make to contestants' points.
+     */
+    void ApplyScoreDeltas(const std::vector< ScoreDelta >& deltas);
+
+    /**
+     * This method reads contestants' points from the given score file,
+     * and adds them to the points the contestants already have.
+     * The file is read and applied in batches, so that files of any
+     * size can be imported without holding up the game.
+     *
+     * @param[in] path
+     *     This is the path of the score file to import.
+     *
+     * @param[in] format
+     *     This is the format in which the score file was written.
+     *
+     * @return
+     *     An indication of whether or not the whole score file
+     *     was imported is returned.  If the file is found to be
+     *     truncated or corrupt, the records before the problem
+     *     have already been imported.
+     */
+    bool ImportScores(
+        const std::string& path,
+        ScoreFileFormat format
+    );
+
+    /**
+     * This method writes the points of every contestant in every
+     * channel to the given score file.  Contestants are copied out
+     * in batches, so that exporting doesn't hold up the game, and
+     * doesn't need memory for every contestant at once.
+     *
+     * @param[in] path
+     *     This is the path of the score file to create.
+     *
+     * @param[in] format
+     *     This is the format in which to write the score file.
+     *
+     * @return
+     *     An indication of whether or not the score file
+     *     was written is returned.
+     */
+    bool ExportScores(
+        const std::string& path,
+        ScoreFileFormat format
+    );
+
     /**
      * This method is called to initiate logging into Twitch chat.
      *
      * @param[in] token
      *     This is the OAuth token to use in authenticating with Twitch.
      *
-     * @param[in] channel
-     *     This is the channel in which to participate in chat.
+     * @param[in] channels
+     *     These are the channels in which to participate in chat.
      *
      * @param[in] nickname
      *     This is the nickname to use on Twitch.
      */
     void InitiateLogIn(
         const std::string& token,
-        const std::string& channel,
+        const std::vector< std::string >& channels,
         const std::string& nickname
     );
 
     /**
      * This method is called to initiate logging out of Twitch chat.
+     * If a snapshot file is in use, the state of the bot is saved to it.
      */
     void InitiateLogOut();
 
@@ -77,6 +236,16 @@ public:
      */
     bool AwaitLogOut();
 
+    // Public Properties
+public:
+    /**
+     * This is the largest number of questions which may be open at once
+     * in each channel.  It's well below the number of different answers
+     * the easiest questions can have, so that a question whose answer
+     * differs from those of the questions still open can be found.
+     */
+    static constexpr size_t MAX_OPEN_QUESTIONS = 16;
+
     // Private properties
 private:
     /**
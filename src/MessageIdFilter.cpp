@@ -0,0 +1,128 @@
+/**
+ * @file MessageIdFilter.cpp
+ *
+ * This module contains the implementation of the MessageIdFilter class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Fnv1a.hpp"
+#include "MessageIdFilter.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of consecutive table slots examined,
+     * starting at the slot selected by an ID's hash, when looking
+     * up or remembering the ID.
+     */
+    constexpr size_t MAX_PROBES = 8;
+
+    /**
+     * This is one slot in the table of remembered message IDs.
+     */
+    struct Slot {
+        /**
+         * This is the hash of the remembered message ID,
+         * or zero if the slot is empty.
+         */
+        uint64_t hash = 0;
+
+        /**
+         * This is the time (according to the time keeper) when
+         * the message ID was remembered.
+         */
+        double time = 0.0;
+    };
+
+    /**
+     * This function computes the 64-bit FNV-1a hash of the given string.
+     *
+     * @param[in] s
+     *     This is the string to hash.
+     *
+     * @return
+     *     The hash of the string is returned.  It is never zero,
+     *     since zero marks an empty slot.
+     */
+    uint64_t Hash(const std::string& s) {
+        const auto hash = Fnv1a(s.data(), s.length());
+        return (hash == 0) ? 1 : hash;
+    }
+
+}
+
+/**
+ * This contains the private properties of a MessageIdFilter class instance.
+ */
+struct MessageIdFilter::Impl {
+    /**
+     * This is the table of remembered message IDs.
+     */
+    std::vector< Slot > slots;
+
+    /**
+     * This is used to select a table slot from an ID's hash.
+     */
+    size_t mask = 0;
+
+    /**
+     * This is the number of seconds for which an ID is remembered.
+     */
+    double window = 0.0;
+};
+
+MessageIdFilter::~MessageIdFilter() noexcept = default;
+
+MessageIdFilter::MessageIdFilter(
+    size_t capacity,
+    double window
+)
+    : impl_(new Impl())
+{
+    size_t size = MAX_PROBES;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    impl_->slots.resize(size);
+    impl_->mask = size - 1;
+    impl_->window = window;
+}
+
+bool MessageIdFilter::IsDuplicate(
+    const std::string& id,
+    double now
+) {
+    const auto hash = Hash(id);
+    const auto oldestAllowed = now - impl_->window;
+    Slot* replacement = nullptr;
+    bool replacementExpired = false;
+    for (size_t i = 0; i < MAX_PROBES; ++i) {
+        auto& slot = impl_->slots[(hash + i) & impl_->mask];
+        const auto expired = (
+            (slot.hash == 0)
+            || (slot.time < oldestAllowed)
+        );
+        if (!expired && (slot.hash == hash)) {
+            return true;
+        }
+        if (replacementExpired) {
+            continue;
+        }
+        if (expired) {
+            replacement = &slot;
+            replacementExpired = true;
+        } else if (
+            (replacement == nullptr)
+            || (slot.time < replacement->time)
+        ) {
+            replacement = &slot;
+        }
+    }
+    replacement->hash = hash;
+    replacement->time = now;
+    return false;
+}
@@ -0,0 +1,88 @@
+#ifndef MESSAGE_ID_FILTER_HPP
+#define MESSAGE_ID_FILTER_HPP
+
+/**
+ * @file MessageIdFilter.hpp
+ *
+ * This module declares the MessageIdFilter implementation.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This remembers the IDs of recently received messages, in order to
+ * detect messages delivered more than once (for example, when chat
+ * is redelivered after reconnecting to Twitch).
+ *
+ * IDs are kept in a fixed-size hash table, so the memory used
+ * does not grow with the amount of chat, and each check takes
+ * a small, bounded amount of time.  IDs older than the filter's
+ * window are forgotten, as are the oldest IDs in the table when
+ * the table gets crowded.
+ */
+class MessageIdFilter {
+    // Lifecycle Methods
+public:
+    ~MessageIdFilter() noexcept;
+    MessageIdFilter(const MessageIdFilter&) = delete;
+    MessageIdFilter(MessageIdFilter&&) noexcept = delete;
+    MessageIdFilter& operator=(const MessageIdFilter&) = delete;
+    MessageIdFilter& operator=(MessageIdFilter&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] capacity
+     *     This is the number of IDs the filter can remember.
+     *     It is rounded up to a power of two.
+     *
+     * @param[in] window
+     *     This is the number of seconds for which an ID is remembered.
+     */
+    MessageIdFilter(
+        size_t capacity,
+        double window
+    );
+
+    /**
+     * This method checks whether or not the given message ID
+     * has been seen within the filter's window, and remembers it
+     * if not.
+     *
+     * @param[in] id
+     *     This is the message ID to check.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
+     *
+     * @return
+     *     An indication of whether or not the message ID was already
+     *     seen within the filter's window is returned.
+     */
+    bool IsDuplicate(
+        const std::string& id,
+        double now
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* MESSAGE_ID_FILTER_HPP */
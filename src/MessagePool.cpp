@@ -0,0 +1,125 @@
+/**
+ * @file MessagePool.cpp
+ *
+ * This module contains the implementations of the PooledMessage structure
+ * and the MessagePool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "MessagePool.hpp"
+#include "MpscRingBuffer.hpp"
+
+#include <string.h>
+
+namespace {
+
+    /**
+     * This function copies a name into inline storage.
+     *
+     * @param[in] name
+     *     This is the name to copy.
+     *
+     * @param[in] toLower
+     *     This indicates whether or not to convert the name to lowercase.
+     *
+     * @param[out] chars
+     *     This is where to copy the name.  It must have room for
+     *     PooledMessage::MAX_NAME_LENGTH characters.
+     *
+     * @param[out] length
+     *     This is where to store the length of the name.
+     *
+     * @return
+     *     An indication of whether or not the name fit is returned.
+     */
+    bool CopyName(
+        const std::string& name,
+        bool toLower,
+        char* chars,
+        size_t& length
+    ) {
+        length = name.length();
+        if (length > PooledMessage::MAX_NAME_LENGTH) {
+            return false;
+        }
+        if (toLower) {
+            for (size_t i = 0; i < length; ++i) {
+                const auto c = name[i];
+                chars[i] = ((c >= 'A') && (c <= 'Z')) ? (char)(c - 'A' + 'a') : c;
+            }
+        } else {
+            (void)memcpy(chars, name.data(), length);
+        }
+        return true;
+    }
+
+}
+
+constexpr size_t PooledMessage::MAX_NAME_LENGTH;
+
+bool PooledMessage::Assign(
+    Twitch::Messaging::MessageInfo&& messageInfo,
+    double time
+) {
+    if (
+        !CopyName(messageInfo.user, false, nickname, nicknameLength)
+        || !CopyName(messageInfo.channel, true, channel, channelLength)
+    ) {
+        return false;
+    }
+    msgId.swap(messageInfo.tags.id);
+    content.swap(messageInfo.messageContent);
+    receivedTime = time;
+    return true;
+}
+
+/**
+ * This contains the private properties of a MessagePool class instance.
+ */
+struct MessagePool::Impl {
+    /**
+     * These are all the messages in the pool.
+     */
+    std::unique_ptr< PooledMessage[] > messages;
+
+    /**
+     * These are the messages not currently in use.
+     */
+    MpscRingBuffer< PooledMessage* > freeMessages;
+
+    /**
+     * This is the constructor.
+     *
+     * @param[in] size
+     *     This is the number of messages in the pool.
+     */
+    explicit Impl(size_t size)
+        : messages(new PooledMessage[size])
+        , freeMessages(size)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            (void)freeMessages.TryPush(&messages[i]);
+        }
+    }
+};
+
+MessagePool::~MessagePool() noexcept = default;
+
+MessagePool::MessagePool(size_t size)
+    : impl_(new Impl(size))
+{
+}
+
+PooledMessage* MessagePool::Acquire() {
+    PooledMessage* message;
+    if (impl_->freeMessages.TryPop(message)) {
+        return message;
+    } else {
+        return nullptr;
+    }
+}
+
+void MessagePool::Release(PooledMessage* message) {
+    (void)impl_->freeMessages.TryPush(std::move(message));
+}
@@ -0,0 +1,156 @@
+#ifndef MESSAGE_POOL_HPP
+#define MESSAGE_POOL_HPP
+
+/**
+ * @file MessagePool.hpp
+ *
+ * This module declares the PooledMessage structure and
+ * the MessagePool implementation.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <Twitch/Messaging.hpp>
+
+/**
+ * This holds the parts of a chat message which the bot uses, in storage
+ * which is reused from one message to the next, so that holding
+ * a message doesn't allocate memory once the bot has warmed up.
+ *
+ * Nicknames and channel names are short (Twitch limits them to 25
+ * characters), so they are copied inline.  The content and `id` tag are
+ * swapped in from the message received, rather than copied.
+ */
+struct PooledMessage {
+    // Properties
+
+    /**
+     * This is the longest nickname or channel name which can be held.
+     */
+    static constexpr size_t MAX_NAME_LENGTH = 32;
+
+    /**
+     * This holds the nickname of the user who sent the message.
+     */
+    char nickname[MAX_NAME_LENGTH];
+
+    /**
+     * This is the number of characters in the nickname.
+     */
+    size_t nicknameLength = 0;
+
+    /**
+     * This holds the name of the channel to which the message was sent,
+     * in lowercase.
+     */
+    char channel[MAX_NAME_LENGTH];
+
+    /**
+     * This is the number of characters in the channel name.
+     */
+    size_t channelLength = 0;
+
+    /**
+     * This is the `id` tag of the message.
+     */
+    std::string msgId;
+
+    /**
+     * This is the content of the message.
+     */
+    std::string content;
+
+    /**
+     * This is the time (according to the time keeper) when
+     * the message was received.
+     */
+    double receivedTime = 0.0;
+
+    // Methods
+
+    /**
+     * This method fills in the message from the given message received
+     * from Twitch, taking its content and `id` tag.
+     *
+     * @param[in,out] messageInfo
+     *     This is the message received from Twitch.  Its content
+     *     and `id` tag are swapped with those previously held.
+     *
+     * @param[in] time
+     *     This is the time (according to the time keeper) when
+     *     the message was received.
+     *
+     * @return
+     *     An indication of whether or not the message could be held
+     *     is returned.  This is false if the nickname or channel name
+     *     is too long.
+     */
+    bool Assign(
+        Twitch::Messaging::MessageInfo&& messageInfo,
+        double time
+    );
+};
+
+/**
+ * This holds a fixed number of messages which are reused rather than
+ * allocated and freed for each message received.
+ *
+ * Messages may be released back to the pool from any thread,
+ * but must only be acquired from one thread at a time.
+ */
+class MessagePool {
+    // Lifecycle Methods
+public:
+    ~MessagePool() noexcept;
+    MessagePool(const MessagePool&) = delete;
+    MessagePool(MessagePool&&) noexcept = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+    MessagePool& operator=(MessagePool&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] size
+     *     This is the number of messages in the pool.
+     */
+    explicit MessagePool(size_t size);
+
+    /**
+     * This method takes a message out of the pool.
+     *
+     * @return
+     *     A message from the pool is returned, or nullptr if all
+     *     messages in the pool are in use.
+     */
+    PooledMessage* Acquire();
+
+    /**
+     * This method returns a message to the pool.
+     *
+     * @param[in] message
+     *     This is the message to return to the pool.  It must have
+     *     been acquired from this pool.
+     */
+    void Release(PooledMessage* message);
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* MESSAGE_POOL_HPP */
@@ -0,0 +1,182 @@
+#ifndef MPSC_RING_BUFFER_HPP
+#define MPSC_RING_BUFFER_HPP
+
+/**
+ * @file MpscRingBuffer.hpp
+ *
+ * This module declares and implements the MpscRingBuffer class template.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <utility>
+
+/**
+ * This is a bounded first-in, first-out queue which any number of
+ * threads may push onto, and one thread may pop from, without locking.
+ *
+ * Items are moved in and moved out, never copied.  Pushing never
+ * waits on the consumer: if the queue is full, the push fails
+ * immediately and the item is left with the caller.  With only one
+ * producing thread, a push also never waits on other producers,
+ * so it completes in a bounded number of steps.
+ *
+ * The queue is an array of cells, each tagged with a sequence number
+ * which tells producers and the consumer whose turn it is to use the
+ * cell, after the design of Dmitry Vyukov's bounded MPMC queue.
+ *
+ * @note
+ *     T must be default-constructible and move-assignable.
+ */
+template< typename T > class MpscRingBuffer {
+    // Lifecycle Methods
+public:
+    ~MpscRingBuffer() noexcept = default;
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer(MpscRingBuffer&&) noexcept = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(MpscRingBuffer&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] capacity
+     *     This is the number of items the queue can hold.
+     *     It is rounded up to a power of two.
+     */
+    explicit MpscRingBuffer(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * This method moves the given item onto the back of the queue,
+     * unless the queue is full.  It may be called from any thread.
+     *
+     * @param[in,out] item
+     *     This is the item to push.  It's only moved from if the push
+     *     succeeds.
+     *
+     * @return
+     *     An indication of whether or not the item was pushed
+     *     is returned.  This is false if the queue is full.
+     */
+    bool TryPush(T&& item) {
+        auto position = pushPosition_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = cells_[position & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+            if (difference == 0) {
+                if (
+                    pushPosition_.compare_exchange_weak(
+                        position,
+                        position + 1,
+                        std::memory_order_relaxed
+                    )
+                ) {
+                    cell.value = std::move(item);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = pushPosition_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * This method moves the item at the front of the queue, if any,
+     * out of the queue.  It must only be called from one thread
+     * (the consumer) at a time.
+     *
+     * @param[out] item
+     *     This is where to move the item popped.
+     *
+     * @return
+     *     An indication of whether or not an item was popped
+     *     is returned.  This is false if the queue is empty.
+     */
+    bool TryPop(T& item) {
+        auto& cell = cells_[popPosition_ & mask_];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != popPosition_ + 1) {
+            return false;
+        }
+        item = std::move(cell.value);
+        cell.value = T();
+        cell.sequence.store(popPosition_ + mask_ + 1, std::memory_order_release);
+        ++popPosition_;
+        return true;
+    }
+
+    /**
+     * This method checks whether or not the queue has any items ready
+     * to pop.  It must only be called from the consumer thread.
+     *
+     * @return
+     *     An indication of whether or not the queue has no items ready
+     *     to pop is returned.
+     */
+    bool IsEmpty() const {
+        const auto& cell = cells_[popPosition_ & mask_];
+        return (cell.sequence.load(std::memory_order_acquire) != popPosition_ + 1);
+    }
+
+    // Private properties
+private:
+    /**
+     * This is one slot in the queue.
+     */
+    struct Cell {
+        /**
+         * This tells whose turn it is to use the cell.  It equals the
+         * push position when the cell is free for that push,
+         * and one more than the pop position when it holds the item
+         * for that pop.
+         */
+        std::atomic< size_t > sequence;
+
+        /**
+         * This is the item held in the cell.
+         */
+        T value;
+    };
+
+    /**
+     * These are the cells of the queue.
+     */
+    std::unique_ptr< Cell[] > cells_;
+
+    /**
+     * This is used to turn a position into the index of a cell.
+     */
+    size_t mask_ = 0;
+
+    /**
+     * This is the position at which the next item will be pushed.
+     */
+    std::atomic< size_t > pushPosition_{0};
+
+    /**
+     * This is the position from which the next item will be popped.
+     * Only the consumer thread uses it.
+     */
+    size_t popPosition_ = 0;
+};
+
+#endif /* MPSC_RING_BUFFER_HPP */
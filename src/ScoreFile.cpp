@@ -0,0 +1,470 @@
+/**
+ * @file ScoreFile.cpp
+ *
+ * This module contains the implementations of the ScoreFileWriter
+ * and ScoreFileReader classes.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "ScoreFile.hpp"
+#include "Serialization.hpp"
+
+#include <limits>
+#include <stdint.h>
+#include <stdio.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the bytes which begin every binary score file.
+     */
+    constexpr uint8_t BINARY_MAGIC[] = {'M', 'B', 'S', 'C'};
+
+    /**
+     * This is the version of the binary score file format written
+     * by this module.
+     */
+    constexpr uint8_t BINARY_FORMAT_VERSION = 1;
+
+    /**
+     * This is the header line of every CSV score file.
+     */
+    const std::string CSV_HEADER = "channel,nickname,points";
+
+    /**
+     * This is the number of fields in every line of a CSV score file.
+     */
+    constexpr size_t CSV_FIELD_COUNT = 3;
+
+    /**
+     * These are the kinds of records which follow the header
+     * of a binary score file.
+     */
+    enum class RecordType : uint8_t {
+        /**
+         * This sets the channel of the score records which follow.
+         */
+        Channel = 1,
+
+        /**
+         * This holds the points of one contestant.
+         */
+        Score = 2,
+    };
+
+    /**
+     * This function writes the given string to the given file
+     * as a CSV field, quoting it if necessary.
+     *
+     * @param[in] file
+     *     This is the file to which to write the field.
+     *
+     * @param[in] value
+     *     This is the string to write.
+     */
+    void WriteCsvField(
+        FILE* file,
+        const std::string& value
+    ) {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            (void)fwrite(value.data(), 1, value.length(), file);
+            return;
+        }
+        (void)putc('"', file);
+        for (const auto c: value) {
+            if (c == '"') {
+                (void)putc('"', file);
+            }
+            (void)putc(c, file);
+        }
+        (void)putc('"', file);
+    }
+
+    /**
+     * This function reads one line of CSV from the given file,
+     * splitting it into fields.
+     *
+     * @param[in] file
+     *     This is the file from which to read the line.
+     *
+     * @param[in,out] fields
+     *     This is where to store the fields read.  Strings already
+     *     in it are reused, to avoid allocating memory for every line.
+     *
+     * @param[out] numFields
+     *     This is where to store the number of fields read.
+     *
+     * @param[out] atEnd
+     *     This is where to store an indication of whether or not
+     *     the end of the file was reached before the line began.
+     *
+     * @return
+     *     An indication of whether or not a line was read is returned.
+     */
+    bool ReadCsvLine(
+        FILE* file,
+        std::vector< std::string >& fields,
+        size_t& numFields,
+        bool& atEnd
+    ) {
+        atEnd = false;
+        numFields = 0;
+        bool lineBegun = false;
+        bool fieldBegun = false;
+        bool quoted = false;
+        for (;;) {
+            if (!fieldBegun) {
+                if (numFields == fields.size()) {
+                    fields.emplace_back();
+                }
+                fields[numFields++].clear();
+                fieldBegun = true;
+            }
+            auto& field = fields[numFields - 1];
+            auto c = getc(file);
+            if (c == EOF) {
+                if (quoted) {
+                    return false;
+                }
+                atEnd = !lineBegun;
+                return lineBegun;
+            }
+            lineBegun = true;
+            if (quoted) {
+                if (c == '"') {
+                    c = getc(file);
+                    if (c != '"') {
+                        quoted = false;
+                        if (c == EOF) {
+                            return true;
+                        }
+                        (void)ungetc(c, file);
+                        continue;
+                    }
+                }
+            } else if (c == '"') {
+                if (!field.empty()) {
+                    return false;
+                }
+                quoted = true;
+                continue;
+            } else if (c == ',') {
+                fieldBegun = false;
+                continue;
+            } else if (c == '\r') {
+                continue;
+            } else if (c == '\n') {
+                return true;
+            }
+            if (field.length() >= MAX_STRING_LENGTH) {
+                return false;
+            }
+            field.push_back((char)c);
+        }
+    }
+
+}
+
+/**
+ * This contains the private properties of a ScoreFileWriter
+ * class instance.
+ */
+struct ScoreFileWriter::Impl {
+    // Properties
+
+    /**
+     * This is the score file, or nullptr if not open.
+     */
+    FILE* file = nullptr;
+
+    /**
+     * This is the format in which the file is written.
+     */
+    ScoreFileFormat format = ScoreFileFormat::Csv;
+
+    /**
+     * This indicates whether or not a channel record has been
+     * written to the binary score file.
+     */
+    bool channelWritten = false;
+
+    /**
+     * This is the channel of the last channel record written
+     * to the binary score file.
+     */
+    std::string channel;
+};
+
+ScoreFileWriter::~ScoreFileWriter() noexcept {
+    (void)Close();
+}
+
+ScoreFileWriter::ScoreFileWriter()
+    : impl_(new Impl())
+{
+}
+
+bool ScoreFileWriter::Open(
+    const std::string& path,
+    ScoreFileFormat format
+) {
+    (void)Close();
+    impl_->file = fopen(path.c_str(), "wb");
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    impl_->format = format;
+    impl_->channelWritten = false;
+    impl_->channel.clear();
+    if (format == ScoreFileFormat::Csv) {
+        (void)fputs(CSV_HEADER.c_str(), impl_->file);
+        (void)putc('\n', impl_->file);
+    } else {
+        (void)fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), impl_->file);
+        (void)putc(BINARY_FORMAT_VERSION, impl_->file);
+    }
+    return true;
+}
+
+void ScoreFileWriter::Write(const ScoreRecord& record) {
+    if (impl_->file == nullptr) {
+        return;
+    }
+    if (impl_->format == ScoreFileFormat::Csv) {
+        WriteCsvField(impl_->file, record.channel);
+        (void)putc(',', impl_->file);
+        WriteCsvField(impl_->file, record.nickname);
+        (void)fprintf(impl_->file, ",%d\n", record.points);
+    } else {
+        if (
+            !impl_->channelWritten
+            || (record.channel != impl_->channel)
+        ) {
+            (void)putc((int)RecordType::Channel, impl_->file);
+            WriteString(impl_->file, record.channel);
+            impl_->channel = record.channel;
+            impl_->channelWritten = true;
+        }
+        (void)putc((int)RecordType::Score, impl_->file);
+        WriteString(impl_->file, record.nickname);
+        WriteVarint(impl_->file, ZigZagEncode(record.points));
+    }
+}
+
+bool ScoreFileWriter::Close() {
+    if (impl_->file == nullptr) {
+        return true;
+    }
+    const auto written = (
+        (fflush(impl_->file) == 0)
+        && (ferror(impl_->file) == 0)
+    );
+    const auto closed = (fclose(impl_->file) == 0);
+    impl_->file = nullptr;
+    return written && closed;
+}
+
+/**
+ * This contains the private properties of a ScoreFileReader
+ * class instance.
+ */
+struct ScoreFileReader::Impl {
+    // Properties
+
+    /**
+     * This is the score file, or nullptr if not open.
+     */
+    FILE* file = nullptr;
+
+    /**
+     * This is the format in which the file was written.
+     */
+    ScoreFileFormat format = ScoreFileFormat::Csv;
+
+    /**
+     * This indicates whether or not the file was found to be
+     * truncated or corrupt.
+     */
+    bool failed = false;
+
+    /**
+     * This indicates whether or not a channel record has been
+     * read from the binary score file.
+     */
+    bool channelRead = false;
+
+    /**
+     * This is the channel of the last channel record read
+     * from the binary score file.
+     */
+    std::string channel;
+
+    /**
+     * These hold the fields of the last line read
+     * from the CSV score file.
+     */
+    std::vector< std::string > fields;
+
+    // Methods
+
+    /**
+     * This method reads the next record from a CSV score file.
+     *
+     * @param[out] record
+     *     This is where to store the record read.
+     *
+     * @return
+     *     An indication of whether or not a record was read is returned.
+     */
+    bool NextCsv(ScoreRecord& record) {
+        for (;;) {
+            size_t numFields;
+            bool atEnd;
+            if (!ReadCsvLine(file, fields, numFields, atEnd)) {
+                failed = !atEnd;
+                return false;
+            }
+            if (
+                (numFields == 1)
+                && fields[0].empty()
+            ) {
+                continue;
+            }
+            intmax_t points;
+            if (
+                (numFields != CSV_FIELD_COUNT)
+                || (
+                    StringExtensions::ToInteger(fields[2], points)
+                    != StringExtensions::ToIntegerResult::Success
+                )
+                || (points < std::numeric_limits< int >::min())
+                || (points > std::numeric_limits< int >::max())
+            ) {
+                failed = true;
+                return false;
+            }
+            record.channel = fields[0];
+            record.nickname = fields[1];
+            record.points = (int)points;
+            return true;
+        }
+    }
+
+    /**
+     * This method reads the next record from a binary score file.
+     *
+     * @param[out] record
+     *     This is where to store the record read.
+     *
+     * @return
+     *     An indication of whether or not a record was read is returned.
+     */
+    bool NextBinary(ScoreRecord& record) {
+        for (;;) {
+            const auto type = getc(file);
+            if (type == EOF) {
+                return false;
+            } else if (type == (int)RecordType::Channel) {
+                if (!ReadString(file, channel)) {
+                    failed = true;
+                    return false;
+                }
+                channelRead = true;
+            } else if (type == (int)RecordType::Score) {
+                uint64_t encodedPoints;
+                if (
+                    !channelRead
+                    || !ReadString(file, record.nickname)
+                    || !ReadVarint(file, encodedPoints)
+                ) {
+                    failed = true;
+                    return false;
+                }
+                const auto points = ZigZagDecode(encodedPoints);
+                if (
+                    (points < std::numeric_limits< int >::min())
+                    || (points > std::numeric_limits< int >::max())
+                ) {
+                    failed = true;
+                    return false;
+                }
+                record.channel = channel;
+                record.points = (int)points;
+                return true;
+            } else {
+                failed = true;
+                return false;
+            }
+        }
+    }
+};
+
+ScoreFileReader::~ScoreFileReader() noexcept {
+    if (impl_->file != nullptr) {
+        (void)fclose(impl_->file);
+    }
+}
+
+ScoreFileReader::ScoreFileReader()
+    : impl_(new Impl())
+{
+}
+
+bool ScoreFileReader::Open(
+    const std::string& path,
+    ScoreFileFormat format
+) {
+    if (impl_->file != nullptr) {
+        (void)fclose(impl_->file);
+    }
+    impl_->format = format;
+    impl_->failed = false;
+    impl_->channelRead = false;
+    impl_->file = fopen(path.c_str(), "rb");
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    if (format == ScoreFileFormat::Csv) {
+        size_t numFields;
+        bool atEnd;
+        return (
+            ReadCsvLine(impl_->file, impl_->fields, numFields, atEnd)
+            && (numFields == CSV_FIELD_COUNT)
+            && (
+                StringExtensions::ToLower(
+                    impl_->fields[0] + ","
+                    + impl_->fields[1] + ","
+                    + impl_->fields[2]
+                ) == CSV_HEADER
+            )
+        );
+    } else {
+        for (size_t i = 0; i < sizeof(BINARY_MAGIC); ++i) {
+            if (getc(impl_->file) != BINARY_MAGIC[i]) {
+                return false;
+            }
+        }
+        return (getc(impl_->file) == BINARY_FORMAT_VERSION);
+    }
+}
+
+bool ScoreFileReader::Next(ScoreRecord& record) {
+    if (
+        (impl_->file == nullptr)
+        || impl_->failed
+    ) {
+        return false;
+    }
+    if (impl_->format == ScoreFileFormat::Csv) {
+        return impl_->NextCsv(record);
+    } else {
+        return impl_->NextBinary(record);
+    }
+}
+
+bool ScoreFileReader::Failed() const {
+    return impl_->failed;
+}
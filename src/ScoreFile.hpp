@@ -0,0 +1,214 @@
+#ifndef SCORE_FILE_HPP
+#define SCORE_FILE_HPP
+
+/**
+ * @file ScoreFile.hpp
+ *
+ * This module declares the ScoreFileWriter and ScoreFileReader
+ * implementations.
+ *
+ * A score file lists the points of contestants, one contestant per
+ * record, in one of two formats:
+ *
+ * - CSV, with a header line of "channel,nickname,points" followed by
+ *   one line per contestant.  Fields containing commas, quotes, or line
+ *   breaks are quoted, with quotes inside them doubled.
+ * - Binary, which begins with a header and is followed by records.
+ *   A channel record sets the channel of the score records after it,
+ *   so that each channel name is written once per run of contestants.
+ *   Strings are prefixed by their lengths, and all integers are written
+ *   as variable-length quantities.
+ *
+ * Both are read and written one record at a time, so that files
+ * of any size can be handled in a constant amount of memory.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <string>
+
+/**
+ * These are the formats in which score files can be written.
+ */
+enum class ScoreFileFormat {
+    /**
+     * This is comma-separated values, for use with spreadsheets
+     * and other tools.
+     */
+    Csv,
+
+    /**
+     * This is a compact binary format.
+     */
+    Binary,
+};
+
+/**
+ * This holds the points of one contestant, as stored in a score file.
+ */
+struct ScoreRecord {
+    /**
+     * This is the channel in which the contestant has the points.
+     */
+    std::string channel;
+
+    /**
+     * This is the nickname of the contestant.
+     */
+    std::string nickname;
+
+    /**
+     * This is the number of points the contestant has.
+     */
+    int points = 0;
+};
+
+/**
+ * This writes contestants' points to a score file.
+ */
+class ScoreFileWriter {
+    // Lifecycle Methods
+public:
+    ~ScoreFileWriter() noexcept;
+    ScoreFileWriter(const ScoreFileWriter&) = delete;
+    ScoreFileWriter(ScoreFileWriter&&) noexcept = delete;
+    ScoreFileWriter& operator=(const ScoreFileWriter&) = delete;
+    ScoreFileWriter& operator=(ScoreFileWriter&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    ScoreFileWriter();
+
+    /**
+     * This method creates (or replaces) the given score file,
+     * and writes its header.
+     *
+     * @param[in] path
+     *     This is the path of the score file to create.
+     *
+     * @param[in] format
+     *     This is the format in which to write the file.
+     *
+     * @return
+     *     An indication of whether or not the file was created
+     *     is returned.
+     */
+    bool Open(
+        const std::string& path,
+        ScoreFileFormat format
+    );
+
+    /**
+     * This method writes the given record to the score file.
+     *
+     * @param[in] record
+     *     This is the record to write.
+     */
+    void Write(const ScoreRecord& record);
+
+    /**
+     * This method finishes writing the score file and closes it.
+     *
+     * @return
+     *     An indication of whether or not everything was written
+     *     to the file is returned.
+     */
+    bool Close();
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+/**
+ * This reads contestants' points back out of a score file,
+ * one record at a time, in the order they were written.
+ */
+class ScoreFileReader {
+    // Lifecycle Methods
+public:
+    ~ScoreFileReader() noexcept;
+    ScoreFileReader(const ScoreFileReader&) = delete;
+    ScoreFileReader(ScoreFileReader&&) noexcept = delete;
+    ScoreFileReader& operator=(const ScoreFileReader&) = delete;
+    ScoreFileReader& operator=(ScoreFileReader&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    ScoreFileReader();
+
+    /**
+     * This method opens the given score file for reading.
+     *
+     * @param[in] path
+     *     This is the path of the score file to open.
+     *
+     * @param[in] format
+     *     This is the format in which the file was written.
+     *
+     * @return
+     *     An indication of whether or not the file was opened
+     *     and begins with a valid header is returned.
+     */
+    bool Open(
+        const std::string& path,
+        ScoreFileFormat format
+    );
+
+    /**
+     * This method reads the next record from the score file.
+     *
+     * @param[out] record
+     *     This is where to store the record read.
+     *
+     * @return
+     *     An indication of whether or not a record was read is returned.
+     *     This is false at the end of the file, or if the file
+     *     is truncated or corrupt.
+     */
+    bool Next(ScoreRecord& record);
+
+    /**
+     * This method indicates whether or not reading stopped because
+     * the score file is truncated or corrupt, rather than because
+     * the end of the file was reached.
+     *
+     * @return
+     *     An indication of whether or not the score file was found
+     *     to be truncated or corrupt is returned.
+     */
+    bool Failed() const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* SCORE_FILE_HPP */
@@ -0,0 +1,571 @@
+/**
+ * @file ScoreWindows.cpp
+ *
+ * This module contains the implementation of the ScoreWindows class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "ScoreWindows.hpp"
+#include "Serialization.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <set>
+#include <stdint.h>
+#include <unordered_map>
+
+namespace {
+
+    /**
+     * This is the number of seconds covered by each bucket.
+     */
+    constexpr double BUCKET_DURATION = 3600.0;
+
+    /**
+     * This is the number of buckets in the ring, which is enough
+     * to cover the longest window which isn't a season.
+     */
+    constexpr size_t NUM_BUCKETS = 7 * 24;
+
+    /**
+     * This is the number of windows which cover a fixed number of
+     * the most recent buckets, as opposed to the current season.
+     * These windows come first in the ScoreWindow enumeration.
+     */
+    constexpr size_t NUM_ROLLING_WINDOWS = 2;
+
+    /**
+     * These are the numbers of the most recent buckets covered by
+     * each window which isn't a season.
+     */
+    constexpr intmax_t WINDOW_BUCKETS[NUM_ROLLING_WINDOWS] = {
+        24,         // Day
+        7 * 24,     // Week
+    };
+
+    /**
+     * This is the number of windows, including the season.
+     */
+    constexpr size_t NUM_WINDOWS = NUM_ROLLING_WINDOWS + 1;
+
+    /**
+     * This is the index of the season among the windows.
+     */
+    constexpr size_t SEASON_WINDOW = (size_t)ScoreWindow::Season;
+
+    /**
+     * This is the number of seconds in each season.
+     */
+    constexpr double SEASON_DURATION = 28 * 24 * 3600.0;
+
+    /**
+     * This is used in place of a bucket or season number
+     * to mean "none".
+     */
+    constexpr intmax_t NONE = std::numeric_limits< intmax_t >::min();
+
+    /**
+     * This holds the totals of one contestant's points.
+     */
+    struct Entry {
+        /**
+         * This is the ID of the nickname of the contestant.
+         */
+        size_t nicknameId = 0;
+
+        /**
+         * These are the totals of the contestant's points
+         * within each window.
+         */
+        int points[NUM_WINDOWS] = {0, 0, 0};
+
+        /**
+         * These are the numbers of buckets within each window which
+         * isn't a season in which the contestant's points changed.
+         * The contestant is in the window's ordering only while
+         * this is nonzero.
+         */
+        size_t bucketsInWindow[NUM_ROLLING_WINDOWS] = {0, 0};
+
+        /**
+         * This is the number of the season whose total of points
+         * is kept for the contestant.  The contestant is in the
+         * season's ordering only while this is the current season.
+         */
+        intmax_t season = NONE;
+
+        /**
+         * This is the number of the most recent bucket in which
+         * the contestant's points changed.
+         */
+        intmax_t lastBucket = NONE;
+
+        /**
+         * This is the index of the contestant in the list of contestants
+         * of the most recent bucket in which its points changed.
+         */
+        size_t lastBucketIndex = 0;
+    };
+
+    /**
+     * This is the change to one contestant's points within one bucket.
+     */
+    struct BucketEntry {
+        /**
+         * This is the contestant whose points changed.
+         */
+        Entry* entry;
+
+        /**
+         * This is the number of points the contestant gained
+         * (or lost, if negative) within the bucket.
+         */
+        int points;
+    };
+
+    /**
+     * This holds the changes to contestants' points within one span
+     * of BUCKET_DURATION seconds.
+     */
+    struct Bucket {
+        /**
+         * This is the number of the span of time covered by the bucket,
+         * counting from the start of the time keeper's epoch,
+         * or NONE if the bucket hasn't been used.
+         */
+        intmax_t number = NONE;
+
+        /**
+         * These are the changes to contestants' points
+         * within the bucket.
+         */
+        std::vector< BucketEntry > entries;
+    };
+
+    /**
+     * This orders contestants by their totals within one window,
+     * from most to fewest points, and then by nickname ID.
+     */
+    struct Ranking {
+        /**
+         * This is the index of the window by whose totals
+         * to order contestants.
+         */
+        size_t window;
+
+        bool operator()(const Entry* lhs, const Entry* rhs) const {
+            if (lhs->points[window] != rhs->points[window]) {
+                return lhs->points[window] > rhs->points[window];
+            }
+            return lhs->nicknameId < rhs->nicknameId;
+        }
+    };
+
+}
+
+/**
+ * This contains the private properties of a ScoreWindows class instance.
+ */
+struct ScoreWindows::Impl {
+    // Properties
+
+    /**
+     * These are the totals of the points of every contestant whose
+     * points have changed within any window, keyed by nickname ID.
+     */
+    std::unordered_map< size_t, Entry > entries;
+
+    /**
+     * This is the ring of buckets, indexed by bucket number
+     * modulo the number of buckets.
+     */
+    std::vector< Bucket > buckets;
+
+    /**
+     * These hold, for each window, the contestants whose points changed
+     * within the window, ordered by their totals within the window.
+     */
+    std::vector< std::set< Entry*, Ranking > > rankings;
+
+    /**
+     * This is the number of the bucket to which points are being added.
+     */
+    intmax_t currentBucket = NONE;
+
+    /**
+     * This is the number of the current season.
+     */
+    intmax_t currentSeason = NONE;
+
+    // Methods
+
+    /**
+     * This is the constructor of the structure.
+     */
+    Impl()
+        : buckets(NUM_BUCKETS)
+    {
+        for (size_t window = 0; window < NUM_WINDOWS; ++window) {
+            rankings.emplace_back(Ranking{window});
+        }
+    }
+
+    /**
+     * This method returns the slot in the ring which holds,
+     * or would hold, the bucket with the given number.
+     *
+     * @param[in] number
+     *     This is the number of the bucket.
+     *
+     * @return
+     *     The slot in the ring for the bucket is returned.
+     */
+    Bucket& GetBucket(intmax_t number) {
+        const auto numBuckets = (intmax_t)NUM_BUCKETS;
+        return buckets[(size_t)(((number % numBuckets) + numBuckets) % numBuckets)];
+    }
+
+    /**
+     * This method returns the totals of the given contestant,
+     * adding them if the contestant's points haven't changed
+     * within any window.
+     *
+     * @param[in] nicknameId
+     *     This is the ID of the nickname of the contestant.
+     *
+     * @return
+     *     The totals of the contestant are returned.
+     */
+    Entry& GetEntry(size_t nicknameId) {
+        auto entriesEntry = entries.find(nicknameId);
+        if (entriesEntry == entries.end()) {
+            entriesEntry = entries.emplace(nicknameId, Entry()).first;
+            entriesEntry->second.nicknameId = nicknameId;
+        }
+        return entriesEntry->second;
+    }
+
+    /**
+     * This method drops the totals of the given contestant if
+     * it's no longer in any window, which happens once every bucket
+     * in which its points changed has fallen out of every window,
+     * and its season is over.
+     *
+     * @param[in] entry
+     *     This is the contestant whose totals may be dropped.
+     */
+    void DropIfExpired(const Entry& entry) {
+        for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+            if (entry.bucketsInWindow[window] > 0) {
+                return;
+            }
+        }
+        if (entry.season == currentSeason) {
+            return;
+        }
+        (void)entries.erase(entry.nicknameId);
+    }
+
+    /**
+     * This method removes the given contestant from the ordering
+     * of every window it's in, so that its totals can be changed.
+     *
+     * @param[in] entry
+     *     This is the contestant to remove.
+     */
+    void Unrank(Entry& entry) {
+        for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+            if (entry.bucketsInWindow[window] > 0) {
+                (void)rankings[window].erase(&entry);
+            }
+        }
+        if (entry.season == currentSeason) {
+            (void)rankings[SEASON_WINDOW].erase(&entry);
+        }
+    }
+
+    /**
+     * This method adds the given contestant to the ordering of every
+     * window in which its points changed.
+     *
+     * @param[in] entry
+     *     This is the contestant to add.
+     */
+    void Rank(Entry& entry) {
+        for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+            if (entry.bucketsInWindow[window] > 0) {
+                (void)rankings[window].insert(&entry);
+            }
+        }
+        if (entry.season == currentSeason) {
+            (void)rankings[SEASON_WINDOW].insert(&entry);
+        }
+    }
+
+    /**
+     * This method takes the changes in the given bucket out of the totals
+     * of the given window, once the bucket has fallen out of the window.
+     * Contestants which are then in no window are dropped.
+     *
+     * @param[in] number
+     *     This is the number of the bucket which fell out of the window.
+     *
+     * @param[in] window
+     *     This is the index of the window.
+     */
+    void Expire(
+        intmax_t number,
+        size_t window
+    ) {
+        auto& bucket = GetBucket(number);
+        if (bucket.number != number) {
+            return;
+        }
+        auto& ranking = rankings[window];
+        for (const auto& bucketEntry: bucket.entries) {
+            auto& entry = *bucketEntry.entry;
+            (void)ranking.erase(&entry);
+            entry.points[window] -= bucketEntry.points;
+            if (--entry.bucketsInWindow[window] > 0) {
+                (void)ranking.insert(&entry);
+            } else {
+                DropIfExpired(entry);
+            }
+        }
+    }
+
+    /**
+     * This method moves the current bucket and season forward
+     * to the given time, taking out of each window's totals
+     * any buckets which fall out of the window, and dropping
+     * contestants which are then in no window.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
+     */
+    void Advance(double now) {
+        const auto bucket = (intmax_t)floor(now / BUCKET_DURATION);
+        if (currentBucket == NONE) {
+            currentBucket = bucket;
+        } else if (bucket > currentBucket) {
+            const auto lastBucket = std::min(
+                bucket,
+                currentBucket + (intmax_t)NUM_BUCKETS
+            );
+            for (auto next = currentBucket + 1; next <= lastBucket; ++next) {
+                for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+                    Expire(next - WINDOW_BUCKETS[window], window);
+                }
+            }
+            currentBucket = bucket;
+        }
+        const auto season = (intmax_t)floor(now / SEASON_DURATION);
+        if (season > currentSeason) {
+            std::set< Entry*, Ranking > lastSeasonRanking(Ranking{SEASON_WINDOW});
+            lastSeasonRanking.swap(rankings[SEASON_WINDOW]);
+            currentSeason = season;
+            for (const auto entry: lastSeasonRanking) {
+                DropIfExpired(*entry);
+            }
+        }
+    }
+
+    /**
+     * This method adds the given points to the given contestant's
+     * change within the current bucket and season.
+     *
+     * @param[in,out] entry
+     *     This is the contestant whose points changed.
+     *
+     * @param[in] points
+     *     This is the number of points to add.
+     */
+    void Credit(
+        Entry& entry,
+        int points
+    ) {
+        Unrank(entry);
+        if (entry.season != currentSeason) {
+            entry.season = currentSeason;
+            entry.points[SEASON_WINDOW] = 0;
+        }
+        auto& bucket = GetBucket(currentBucket);
+        if (bucket.number != currentBucket) {
+            bucket.number = currentBucket;
+            bucket.entries.clear();
+        }
+        if (entry.lastBucket != currentBucket) {
+            entry.lastBucket = currentBucket;
+            entry.lastBucketIndex = bucket.entries.size();
+            bucket.entries.push_back({&entry, 0});
+            for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+                ++entry.bucketsInWindow[window];
+            }
+        }
+        bucket.entries[entry.lastBucketIndex].points += points;
+        for (auto& windowPoints: entry.points) {
+            windowPoints += points;
+        }
+        Rank(entry);
+    }
+};
+
+ScoreWindows::~ScoreWindows() noexcept = default;
+ScoreWindows::ScoreWindows(ScoreWindows&&) noexcept = default;
+ScoreWindows& ScoreWindows::operator=(ScoreWindows&&) noexcept = default;
+
+ScoreWindows::ScoreWindows()
+    : impl_(new Impl())
+{
+}
+
+void ScoreWindows::AddPoints(
+    size_t nicknameId,
+    int points,
+    double now
+) {
+    impl_->Advance(now);
+    impl_->Credit(impl_->GetEntry(nicknameId), points);
+}
+
+auto ScoreWindows::GetTop(
+    ScoreWindow window,
+    size_t count,
+    double now
+) -> std::vector< Standing > {
+    impl_->Advance(now);
+    std::vector< Standing > standings;
+    for (const auto entry: impl_->rankings[(size_t)window]) {
+        if (standings.size() >= count) {
+            break;
+        }
+        Standing standing;
+        standing.nicknameId = entry->nicknameId;
+        standing.points = entry->points[(size_t)window];
+        standings.push_back(std::move(standing));
+    }
+    return standings;
+}
+
+size_t ScoreWindows::CountContestants() const {
+    return impl_->entries.size();
+}
+
+void ScoreWindows::WriteState(
+    std::ostream& stream,
+    const StringInterner& nicknames
+) const {
+    std::vector< const Bucket* > buckets;
+    if (impl_->currentBucket != NONE) {
+        for (const auto& bucket: impl_->buckets) {
+            if (
+                (bucket.number != NONE)
+                && (bucket.number > impl_->currentBucket - (intmax_t)NUM_BUCKETS)
+                && !bucket.entries.empty()
+            ) {
+                buckets.push_back(&bucket);
+            }
+        }
+    }
+    stream
+        << impl_->currentBucket << ' '
+        << impl_->currentSeason << ' '
+        << buckets.size();
+    for (const auto bucket: buckets) {
+        stream << ' ' << bucket->number << ' ' << bucket->entries.size();
+        for (const auto& bucketEntry: bucket->entries) {
+            stream << ' ';
+            WriteSnapshotString(stream, nicknames.GetString(bucketEntry.entry->nicknameId));
+            stream << ' ' << bucketEntry.points;
+        }
+    }
+    const auto& seasonRanking = impl_->rankings[SEASON_WINDOW];
+    stream << ' ' << seasonRanking.size();
+    for (const auto entry: seasonRanking) {
+        stream << ' ';
+        WriteSnapshotString(stream, nicknames.GetString(entry->nicknameId));
+        stream << ' ' << entry->points[SEASON_WINDOW];
+    }
+}
+
+bool ScoreWindows::ReadState(
+    std::istream& stream,
+    StringInterner& nicknames
+) {
+    std::unique_ptr< Impl > restored(new Impl());
+    size_t numBuckets;
+    if (
+        !(
+            stream
+            >> restored->currentBucket
+            >> restored->currentSeason
+            >> numBuckets
+        )
+        || (numBuckets > NUM_BUCKETS)
+    ) {
+        return false;
+    }
+    const auto currentBucket = restored->currentBucket;
+    std::string nickname;
+    for (size_t i = 0; i < numBuckets; ++i) {
+        intmax_t number;
+        size_t numEntries;
+        if (
+            (currentBucket == NONE)
+            || !(stream >> number >> numEntries)
+            || (number > currentBucket)
+            || (number <= currentBucket - (intmax_t)NUM_BUCKETS)
+        ) {
+            return false;
+        }
+        auto& bucket = restored->GetBucket(number);
+        if (bucket.number != NONE) {
+            return false;
+        }
+        bucket.number = number;
+        for (size_t j = 0; j < numEntries; ++j) {
+            int points;
+            if (
+                !ReadSnapshotString(stream >> std::ws, nickname)
+                || !(stream >> points)
+            ) {
+                return false;
+            }
+            auto& entry = restored->GetEntry(nicknames.Intern(nickname));
+            if (number == currentBucket) {
+                entry.lastBucket = number;
+                entry.lastBucketIndex = bucket.entries.size();
+            }
+            bucket.entries.push_back({&entry, points});
+            for (size_t window = 0; window < NUM_ROLLING_WINDOWS; ++window) {
+                if (number > currentBucket - WINDOW_BUCKETS[window]) {
+                    entry.points[window] += points;
+                    ++entry.bucketsInWindow[window];
+                }
+            }
+        }
+    }
+    size_t numSeasonEntries;
+    if (!(stream >> numSeasonEntries)) {
+        return false;
+    }
+    for (size_t i = 0; i < numSeasonEntries; ++i) {
+        int points;
+        if (
+            !ReadSnapshotString(stream >> std::ws, nickname)
+            || !(stream >> points)
+        ) {
+            return false;
+        }
+        auto& entry = restored->GetEntry(nicknames.Intern(nickname));
+        entry.season = restored->currentSeason;
+        entry.points[SEASON_WINDOW] = points;
+    }
+    for (auto& entriesEntry: restored->entries) {
+        restored->Rank(entriesEntry.second);
+    }
+    impl_ = std::move(restored);
+    return true;
+}
@@ -0,0 +1,199 @@
+#ifndef SCORE_WINDOWS_HPP
+#define SCORE_WINDOWS_HPP
+
+/**
+ * @file ScoreWindows.hpp
+ *
+ * This module declares the ScoreWindows implementation.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "StringInterner.hpp"
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * These are the spans of time over which contestants' points
+ * can be totaled for a leaderboard.
+ */
+enum class ScoreWindow {
+    /**
+     * This is the last 24 hours.
+     */
+    Day,
+
+    /**
+     * This is the last 7 days.
+     */
+    Week,
+
+    /**
+     * This is the current season.  Seasons are consecutive
+     * 28-day periods.
+     */
+    Season,
+};
+
+/**
+ * This keeps totals of the points gained or lost by contestants
+ * in one channel over the last day, the last week, and the current
+ * season, so that leaderboards for each can be produced quickly.
+ *
+ * Points are added to hourly buckets, kept in a ring covering
+ * the longest window.  Each bucket lists the contestants whose points
+ * changed in it, and each window keeps its contestants ordered
+ * by their totals.  When a bucket falls out of a window, only the
+ * contestants listed in that bucket have their totals for the window
+ * changed, and a leaderboard is read off the front of the window's
+ * ordering, so neither ever needs to look at every contestant.
+ *
+ * Contestants are identified by the IDs of their nicknames, and are
+ * dropped once they're no longer in any window.
+ */
+class ScoreWindows {
+    // Public Types
+public:
+    /**
+     * This is one contestant's place on a leaderboard.
+     */
+    struct Standing {
+        /**
+         * This is the ID of the nickname of the contestant.
+         */
+        size_t nicknameId = 0;
+
+        /**
+         * This is the number of points the contestant gained (or lost,
+         * if negative) within the window.
+         */
+        int points = 0;
+    };
+
+    // Lifecycle Methods
+public:
+    ~ScoreWindows() noexcept;
+    ScoreWindows(const ScoreWindows&) = delete;
+    ScoreWindows(ScoreWindows&&) noexcept;
+    ScoreWindows& operator=(const ScoreWindows&) = delete;
+    ScoreWindows& operator=(ScoreWindows&&) noexcept;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    ScoreWindows();
+
+    /**
+     * This method adds the given points to the totals of the given
+     * contestant in every window.
+     *
+     * @param[in] nicknameId
+     *     This is the ID of the nickname of the contestant.
+     *
+     * @param[in] points
+     *     This is the number of points to add, or (if negative)
+     *     to take away.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
+     */
+    void AddPoints(
+        size_t nicknameId,
+        int points,
+        double now
+    );
+
+    /**
+     * This method returns the contestants with the most points
+     * within the given window, in order from most to fewest points.
+     * Contestants with the same number of points are ordered
+     * by nickname ID.
+     *
+     * @param[in] window
+     *     This is the window whose leaderboard to return.
+     *
+     * @param[in] count
+     *     This is the largest number of contestants to return.
+     *
+     * @param[in] now
+     *     This is the current time (according to the time keeper).
+     *
+     * @return
+     *     The contestants with the most points within the window
+     *     are returned.
+     */
+    std::vector< Standing > GetTop(
+        ScoreWindow window,
+        size_t count,
+        double now
+    );
+
+    /**
+     * This method returns the number of contestants whose totals
+     * are kept, which are those whose points changed within
+     * any window.
+     *
+     * @return
+     *     The number of contestants whose totals are kept is returned.
+     */
+    size_t CountContestants() const;
+
+    /**
+     * This method writes the totals kept by the instance
+     * to the given stream.  Contestants are written by nickname,
+     * so that the totals can be read back with different IDs.
+     *
+     * @param[in,out] stream
+     *     This is the stream to which to write the totals.
+     *
+     * @param[in] nicknames
+     *     These are the nicknames of the contestants, by ID.
+     */
+    void WriteState(
+        std::ostream& stream,
+        const StringInterner& nicknames
+    ) const;
+
+    /**
+     * This method restores the totals kept by the instance from
+     * a stream previously written by WriteState.
+     *
+     * @param[in,out] stream
+     *     This is the stream from which to read the totals.
+     *
+     * @param[in,out] nicknames
+     *     This is used to look up the IDs of the contestants'
+     *     nicknames, interning any which haven't been seen before.
+     *
+     * @return
+     *     An indication of whether or not the totals were restored
+     *     is returned.
+     */
+    bool ReadState(
+        std::istream& stream,
+        StringInterner& nicknames
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* SCORE_WINDOWS_HPP */
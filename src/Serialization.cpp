@@ -0,0 +1,120 @@
+/**
+ * @file Serialization.cpp
+ *
+ * This module contains the implementation of the functions shared
+ * by the modules which write values to files and read them back.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Serialization.hpp"
+
+void AppendVarint(
+    std::vector< uint8_t >& buffer,
+    uint64_t value
+) {
+    while (value >= 0x80) {
+        buffer.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((uint8_t)value);
+}
+
+void AppendString(
+    std::vector< uint8_t >& buffer,
+    const std::string& value
+) {
+    AppendVarint(buffer, value.length());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void WriteVarint(
+    FILE* file,
+    uint64_t value
+) {
+    while (value >= 0x80) {
+        (void)putc((int)((value | 0x80) & 0xFF), file);
+        value >>= 7;
+    }
+    (void)putc((int)value, file);
+}
+
+void WriteString(
+    FILE* file,
+    const std::string& value
+) {
+    WriteVarint(file, value.length());
+    (void)fwrite(value.data(), 1, value.length(), file);
+}
+
+bool ReadVarint(
+    FILE* file,
+    uint64_t& value
+) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        const auto c = getc(file);
+        if (c == EOF) {
+            return false;
+        }
+        value |= ((uint64_t)(c & 0x7F) << shift);
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReadString(
+    FILE* file,
+    std::string& value
+) {
+    uint64_t length;
+    if (
+        !ReadVarint(file, length)
+        || (length > MAX_STRING_LENGTH)
+    ) {
+        return false;
+    }
+    value.resize((size_t)length);
+    return (
+        (length == 0)
+        || (fread(&value[0], 1, (size_t)length, file) == length)
+    );
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+void WriteSnapshotString(
+    std::ostream& stream,
+    const std::string& value
+) {
+    stream << value.length() << ':' << value;
+}
+
+bool ReadSnapshotString(
+    std::istream& stream,
+    std::string& value
+) {
+    size_t length;
+    char separator;
+    if (
+        !(stream >> length)
+        || !stream.get(separator)
+        || (separator != ':')
+        || (length > MAX_STRING_LENGTH)
+    ) {
+        return false;
+    }
+    value.resize(length);
+    return (
+        (length == 0)
+        || stream.read(&value[0], length)
+    );
+}
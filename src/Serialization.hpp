@@ -0,0 +1,187 @@
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+/**
+ * @file Serialization.hpp
+ *
+ * This module declares functions shared by the modules which write
+ * values to files and read them back.
+ *
+ * Integers are written as variable-length quantities (7 bits per byte,
+ * least significant group first), with signed integers first mapped
+ * by ZigZagEncode so that values of small magnitude (of either sign)
+ * encode compactly.  Strings are prefixed by their lengths.
+ *
+ * Snapshots are text, and strings in them are written as their lengths
+ * in decimal, followed by a colon, followed by the strings themselves,
+ * so that they can be read back even if empty or containing whitespace.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * This is the longest string ReadString or ReadSnapshotString
+ * will accept, as a guard against corrupt files.
+ */
+constexpr uint64_t MAX_STRING_LENGTH = 1048576;
+
+/**
+ * This function appends the given value to the given buffer
+ * as a variable-length quantity.
+ *
+ * @param[in,out] buffer
+ *     This is the buffer to which to append the value.
+ *
+ * @param[in] value
+ *     This is the value to append.
+ */
+void AppendVarint(
+    std::vector< uint8_t >& buffer,
+    uint64_t value
+);
+
+/**
+ * This function appends the given string to the given buffer,
+ * prefixed by its length.
+ *
+ * @param[in,out] buffer
+ *     This is the buffer to which to append the string.
+ *
+ * @param[in] value
+ *     This is the string to append.
+ */
+void AppendString(
+    std::vector< uint8_t >& buffer,
+    const std::string& value
+);
+
+/**
+ * This function writes the given value to the given file
+ * as a variable-length quantity.
+ *
+ * @param[in] file
+ *     This is the file to which to write the value.
+ *
+ * @param[in] value
+ *     This is the value to write.
+ */
+void WriteVarint(
+    FILE* file,
+    uint64_t value
+);
+
+/**
+ * This function writes the given string to the given file,
+ * prefixed by its length.
+ *
+ * @param[in] file
+ *     This is the file to which to write the string.
+ *
+ * @param[in] value
+ *     This is the string to write.
+ */
+void WriteString(
+    FILE* file,
+    const std::string& value
+);
+
+/**
+ * This function reads a variable-length quantity from the given file.
+ *
+ * @param[in] file
+ *     This is the file from which to read the value.
+ *
+ * @param[out] value
+ *     This is where to store the value read.
+ *
+ * @return
+ *     An indication of whether or not the value was read is returned.
+ */
+bool ReadVarint(
+    FILE* file,
+    uint64_t& value
+);
+
+/**
+ * This function reads a length-prefixed string from the given file.
+ *
+ * @param[in] file
+ *     This is the file from which to read the string.
+ *
+ * @param[out] value
+ *     This is where to store the string read.
+ *
+ * @return
+ *     An indication of whether or not the string was read is returned.
+ *     This is false if the string is longer than MAX_STRING_LENGTH.
+ */
+bool ReadString(
+    FILE* file,
+    std::string& value
+);
+
+/**
+ * This function maps a signed value to an unsigned one such that
+ * values of small magnitude (of either sign) encode compactly.
+ *
+ * @param[in] value
+ *     This is the value to map.
+ *
+ * @return
+ *     The mapped value is returned.
+ */
+uint64_t ZigZagEncode(int64_t value);
+
+/**
+ * This function reverses the mapping done by ZigZagEncode.
+ *
+ * @param[in] value
+ *     This is the value to map.
+ *
+ * @return
+ *     The original signed value is returned.
+ */
+int64_t ZigZagDecode(uint64_t value);
+
+/**
+ * This function writes the given string to the given stream,
+ * prefixed by its length, so that it can be read back by
+ * ReadSnapshotString.
+ *
+ * @param[in,out] stream
+ *     This is the stream to which to write the string.
+ *
+ * @param[in] value
+ *     This is the string to write.
+ */
+void WriteSnapshotString(
+    std::ostream& stream,
+    const std::string& value
+);
+
+/**
+ * This function reads a string written by WriteSnapshotString
+ * from the given stream.
+ *
+ * @param[in,out] stream
+ *     This is the stream from which to read the string.
+ *
+ * @param[out] value
+ *     This is where to store the string read.
+ *
+ * @return
+ *     An indication of whether or not the string was read is returned.
+ */
+bool ReadSnapshotString(
+    std::istream& stream,
+    std::string& value
+);
+
+#endif /* SERIALIZATION_HPP */
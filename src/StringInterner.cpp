@@ -0,0 +1,139 @@
+/**
+ * @file StringInterner.cpp
+ *
+ * This module contains the implementation of the StringInterner class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Fnv1a.hpp"
+#include "StringInterner.hpp"
+
+#include <deque>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of slots in the hash table when it's created.
+     */
+    constexpr size_t INITIAL_TABLE_SIZE = 64;
+
+    /**
+     * This marks a hash table slot which holds no ID.
+     */
+    constexpr size_t EMPTY_SLOT = (size_t)-1;
+
+}
+
+/**
+ * This contains the private properties of a StringInterner class instance.
+ */
+struct StringInterner::Impl {
+    // Properties
+
+    /**
+     * These are the interned strings, indexed by ID.  A deque is used
+     * so that references to the strings stay valid as more are added.
+     */
+    std::deque< std::string > strings;
+
+    /**
+     * This is an open-addressed hash table of string IDs, probed
+     * linearly.  It's kept at most half full.
+     */
+    std::vector< size_t > table = std::vector< size_t >(INITIAL_TABLE_SIZE, EMPTY_SLOT);
+
+    // Methods
+
+    /**
+     * This method finds the hash table slot which either holds the ID
+     * of the given string, or is empty and would hold it.
+     *
+     * @param[in] chars
+     *     This points to the characters of the string.
+     *
+     * @param[in] length
+     *     This is the number of characters in the string.
+     *
+     * @return
+     *     The index of the hash table slot is returned.
+     */
+    size_t FindSlot(
+        const char* chars,
+        size_t length
+    ) const {
+        const auto mask = table.size() - 1;
+        auto slot = (size_t)Fnv1a(chars, length) & mask;
+        for (;;) {
+            const auto id = table[slot];
+            if (id == EMPTY_SLOT) {
+                return slot;
+            }
+            const auto& s = strings[id];
+            if (
+                (s.length() == length)
+                && (memcmp(s.data(), chars, length) == 0)
+            ) {
+                return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    /**
+     * This method doubles the size of the hash table.
+     */
+    void Grow() {
+        table.assign(table.size() * 2, EMPTY_SLOT);
+        for (size_t id = 0; id < strings.size(); ++id) {
+            const auto& s = strings[id];
+            table[FindSlot(s.data(), s.length())] = id;
+        }
+    }
+};
+
+constexpr size_t StringInterner::NOT_FOUND;
+
+StringInterner::~StringInterner() noexcept = default;
+
+StringInterner::StringInterner()
+    : impl_(new Impl())
+{
+}
+
+size_t StringInterner::Intern(
+    const char* chars,
+    size_t length
+) {
+    auto slot = impl_->FindSlot(chars, length);
+    if (impl_->table[slot] != EMPTY_SLOT) {
+        return impl_->table[slot];
+    }
+    const auto id = impl_->strings.size();
+    impl_->strings.emplace_back(chars, length);
+    if ((impl_->strings.size() * 2) > impl_->table.size()) {
+        impl_->Grow();
+    } else {
+        impl_->table[slot] = id;
+    }
+    return id;
+}
+
+size_t StringInterner::Intern(const std::string& s) {
+    return Intern(s.data(), s.length());
+}
+
+size_t StringInterner::Find(
+    const char* chars,
+    size_t length
+) const {
+    const auto id = impl_->table[impl_->FindSlot(chars, length)];
+    return (id == EMPTY_SLOT) ? NOT_FOUND : id;
+}
+
+const std::string& StringInterner::GetString(size_t id) const {
+    return impl_->strings[id];
+}
@@ -0,0 +1,125 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+/**
+ * @file StringInterner.hpp
+ *
+ * This module declares the StringInterner implementation.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This maps strings to small, stable integer IDs, so that code which
+ * handles many copies of the same few strings (such as nicknames and
+ * channel names) can compare and look them up by ID.
+ *
+ * Strings are looked up by pointer and length, so looking up a string
+ * never allocates memory.  Memory is only allocated the first time
+ * a string is interned.
+ */
+class StringInterner {
+    // Lifecycle Methods
+public:
+    ~StringInterner() noexcept;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner(StringInterner&&) noexcept = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    StringInterner& operator=(StringInterner&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    StringInterner();
+
+    /**
+     * This method returns the ID of the given string,
+     * assigning it the next available ID if it has none yet.
+     *
+     * @param[in] chars
+     *     This points to the characters of the string.
+     *
+     * @param[in] length
+     *     This is the number of characters in the string.
+     *
+     * @return
+     *     The ID of the string is returned.  IDs are assigned
+     *     consecutively starting at zero.
+     */
+    size_t Intern(
+        const char* chars,
+        size_t length
+    );
+
+    /**
+     * This method returns the ID of the given string,
+     * assigning it the next available ID if it has none yet.
+     *
+     * @param[in] s
+     *     This is the string to intern.
+     *
+     * @return
+     *     The ID of the string is returned.  IDs are assigned
+     *     consecutively starting at zero.
+     */
+    size_t Intern(const std::string& s);
+
+    /**
+     * This method returns the ID of the given string, if it has one.
+     *
+     * @param[in] chars
+     *     This points to the characters of the string.
+     *
+     * @param[in] length
+     *     This is the number of characters in the string.
+     *
+     * @return
+     *     The ID of the string is returned, or NOT_FOUND if the
+     *     string has not been interned.
+     */
+    size_t Find(
+        const char* chars,
+        size_t length
+    ) const;
+
+    /**
+     * This method returns the string with the given ID.
+     *
+     * @param[in] id
+     *     This is the ID of the string to return.  It must have been
+     *     returned by Intern.
+     *
+     * @return
+     *     The string with the given ID is returned.
+     */
+    const std::string& GetString(size_t id) const;
+
+    // Public Properties
+public:
+    /**
+     * This is returned by Find if the string has not been interned.
+     */
+    static constexpr size_t NOT_FOUND = (size_t)-1;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STRING_INTERNER_HPP */
@@ -0,0 +1,506 @@
+/**
+ * @file Tracer.cpp
+ *
+ * This module contains the implementations of the Tracer
+ * and TraceSpan classes.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of events each thread's ring buffer can hold.
+     * It must be a power of two.
+     */
+    constexpr size_t THREAD_BUFFER_CAPACITY = 8192;
+
+    /**
+     * This is the number of milliseconds the background writer
+     * waits between writes, if not woken up earlier.
+     */
+    constexpr unsigned int WRITER_PERIOD_MILLISECONDS = 100;
+
+    /**
+     * This is the process ID written with every event.  A trace
+     * only ever holds one process.
+     */
+    constexpr int TRACE_PROCESS_ID = 1;
+
+    /**
+     * This holds one event recorded by a thread, until it's written.
+     */
+    struct TraceEvent {
+        /**
+         * This is the name of the event.
+         */
+        const char* name = nullptr;
+
+        /**
+         * For an asynchronous step, this is the name of the step;
+         * for a thread name, this is the name of the thread.
+         */
+        const char* detail = nullptr;
+
+        /**
+         * This is the time of the event, in nanoseconds
+         * since the trace was opened.
+         */
+        int64_t time = 0;
+
+        /**
+         * For an asynchronous event, this identifies the span
+         * to which the event belongs.
+         */
+        uint64_t id = 0;
+
+        /**
+         * This is the Chrome trace-event phase of the event,
+         * such as 'B' for the beginning of a span.
+         */
+        char phase = 0;
+    };
+
+    /**
+     * This holds the events recorded by one thread.  Only that thread
+     * adds events, and only the background writer takes them out,
+     * so neither needs to lock anything.
+     */
+    struct ThreadBuffer {
+        /**
+         * This is the thread ID written with the thread's events.
+         */
+        unsigned int threadId = 0;
+
+        /**
+         * These are the slots in which events are held.
+         */
+        std::vector< TraceEvent > events;
+
+        /**
+         * This is the number of events ever added.
+         */
+        std::atomic< size_t > head{0};
+
+        /**
+         * This is the number of events ever taken out.
+         */
+        std::atomic< size_t > tail{0};
+
+        /**
+         * This is the number of events dropped because the buffer
+         * was full, since the count was last written.
+         */
+        std::atomic< size_t > dropped{0};
+
+        /**
+         * This is the constructor.
+         *
+         * @param[in] newThreadId
+         *     This is the thread ID written with the thread's events.
+         */
+        explicit ThreadBuffer(unsigned int newThreadId)
+            : threadId(newThreadId)
+            , events(THREAD_BUFFER_CAPACITY)
+        {
+        }
+    };
+
+    /**
+     * This associates the calling thread with its ring buffer
+     * in the tracer it most recently recorded an event to.
+     */
+    struct ThreadRegistration {
+        /**
+         * This is the unique number of the tracer,
+         * or zero if none yet.
+         */
+        uint64_t tracerNumber = 0;
+
+        /**
+         * This is the thread's ring buffer in the tracer.
+         */
+        ThreadBuffer* buffer = nullptr;
+    };
+
+    /**
+     * This is the calling thread's registration.
+     */
+    thread_local ThreadRegistration threadRegistration;
+
+    /**
+     * This is used to give every tracer a unique number,
+     * so that a thread can tell which tracer its registration is for.
+     */
+    std::atomic< uint64_t > nextTracerNumber{1};
+
+}
+
+/**
+ * This contains the private properties of a Tracer class instance.
+ */
+struct Tracer::Impl {
+    // Properties
+
+    /**
+     * This is the unique number of the tracer.
+     */
+    const uint64_t tracerNumber = nextTracerNumber++;
+
+    /**
+     * This indicates whether or not events are being recorded.
+     */
+    std::atomic< bool > enabled{false};
+
+    /**
+     * This is the time when the trace was opened.
+     */
+    std::chrono::steady_clock::time_point startTime;
+
+    /**
+     * This is the trace file, or nullptr if not open.
+     */
+    FILE* file = nullptr;
+
+    /**
+     * This indicates whether or not no events have yet been written
+     * to the trace file.
+     */
+    bool firstEvent = true;
+
+    /**
+     * This is used to synchronize access to the object.
+     */
+    std::mutex mutex;
+
+    /**
+     * This is used to wake up the background writer.
+     */
+    std::condition_variable writerWakeCondition;
+
+    /**
+     * This is the thread which writes events to the file.
+     */
+    std::thread writerThread;
+
+    /**
+     * This flag indicates whether or not the background writer
+     * should stop once everything recorded has been written.
+     */
+    bool stopWriter = false;
+
+    /**
+     * These are the ring buffers of all threads which have
+     * recorded events.
+     */
+    std::vector< std::unique_ptr< ThreadBuffer > > threadBuffers;
+
+    // Methods
+
+    /**
+     * This method returns the calling thread's ring buffer,
+     * making one for it if it doesn't have one yet.
+     *
+     * @return
+     *     The calling thread's ring buffer is returned.
+     */
+    ThreadBuffer* GetThreadBuffer() {
+        if (threadRegistration.tracerNumber != tracerNumber) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            const auto threadId = (unsigned int)threadBuffers.size() + 1;
+            threadBuffers.emplace_back(new ThreadBuffer(threadId));
+            threadRegistration.tracerNumber = tracerNumber;
+            threadRegistration.buffer = threadBuffers.back().get();
+        }
+        return threadRegistration.buffer;
+    }
+
+    /**
+     * This method records an event on the calling thread,
+     * if events are being recorded.
+     *
+     * @param[in] phase
+     *     This is the Chrome trace-event phase of the event.
+     *
+     * @param[in] name
+     *     This is the name of the event.
+     *
+     * @param[in] detail
+     *     For an asynchronous step, this is the name of the step;
+     *     for a thread name, this is the name of the thread.
+     *
+     * @param[in] id
+     *     For an asynchronous event, this identifies the span
+     *     to which the event belongs.
+     */
+    void Record(
+        char phase,
+        const char* name,
+        const char* detail,
+        uint64_t id
+    ) {
+        if (!enabled.load(std::memory_order_acquire)) {
+            return;
+        }
+        const auto buffer = GetThreadBuffer();
+        const auto head = buffer->head.load(std::memory_order_relaxed);
+        const auto tail = buffer->tail.load(std::memory_order_acquire);
+        if (head - tail >= buffer->events.size()) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto& event = buffer->events[head & (buffer->events.size() - 1)];
+        event.phase = phase;
+        event.name = name;
+        event.detail = detail;
+        event.id = id;
+        event.time = (int64_t)std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now() - startTime
+        ).count();
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * This method appends the given event, in Chrome trace-event
+     * JSON format, to the given text.
+     *
+     * @param[in,out] text
+     *     This is the text to which to append the event.
+     *
+     * @param[in] event
+     *     This is the event to append.
+     *
+     * @param[in] threadId
+     *     This is the ID of the thread which recorded the event.
+     */
+    void AppendEvent(
+        std::string& text,
+        const TraceEvent& event,
+        unsigned int threadId
+    ) {
+        char line[256];
+        const auto timestamp = (double)event.time / 1000.0;
+        int length;
+        switch (event.phase) {
+            case 'M': {
+                length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    TRACE_PROCESS_ID, threadId, event.detail
+                );
+            } break;
+
+            case 'b':
+            case 'e': {
+                length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u,\"id\":\"0x%llx\"}",
+                    event.name, event.name, event.phase, timestamp,
+                    TRACE_PROCESS_ID, threadId, (unsigned long long)event.id
+                );
+            } break;
+
+            case 'n': {
+                length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"n\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u,\"id\":\"0x%llx\"}",
+                    event.detail, event.name, timestamp,
+                    TRACE_PROCESS_ID, threadId, (unsigned long long)event.id
+                );
+            } break;
+
+            case 'i': {
+                length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                    event.name, timestamp, TRACE_PROCESS_ID, threadId
+                );
+            } break;
+
+            default: {
+                length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                    event.name, event.phase, timestamp, TRACE_PROCESS_ID, threadId
+                );
+            } break;
+        }
+        if (length <= 0) {
+            return;
+        }
+        text += (firstEvent ? "\n" : ",\n");
+        firstEvent = false;
+        text.append(line, std::min((size_t)length, sizeof(line) - 1));
+    }
+
+    /**
+     * This method takes all events recorded so far out of the threads'
+     * ring buffers, and appends them, in Chrome trace-event JSON
+     * format, to the given text.
+     *
+     * @param[in,out] text
+     *     This is the text to which to append the events.
+     */
+    void TakeEvents(std::string& text) {
+        for (const auto& buffer: threadBuffers) {
+            const auto tail = buffer->tail.load(std::memory_order_relaxed);
+            const auto head = buffer->head.load(std::memory_order_acquire);
+            for (auto i = tail; i != head; ++i) {
+                AppendEvent(
+                    text,
+                    buffer->events[i & (buffer->events.size() - 1)],
+                    buffer->threadId
+                );
+            }
+            buffer->tail.store(head, std::memory_order_release);
+            const auto dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                char line[160];
+                const auto length = snprintf(
+                    line, sizeof(line),
+                    "{\"name\":\"trace events dropped\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u,\"args\":{\"count\":%zu}}",
+                    (double)std::chrono::duration_cast< std::chrono::nanoseconds >(
+                        std::chrono::steady_clock::now() - startTime
+                    ).count() / 1000.0,
+                    TRACE_PROCESS_ID, buffer->threadId, dropped
+                );
+                if (length > 0) {
+                    text += (firstEvent ? "\n" : ",\n");
+                    firstEvent = false;
+                    text.append(line, std::min((size_t)length, sizeof(line) - 1));
+                }
+            }
+        }
+    }
+
+    /**
+     * This function is called in a separate thread to write
+     * recorded events to the file.
+     */
+    void Writer() {
+        std::string text;
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        for (;;) {
+            writerWakeCondition.wait_for(
+                lock,
+                std::chrono::milliseconds(WRITER_PERIOD_MILLISECONDS),
+                [this]{ return stopWriter; }
+            );
+            const auto stopping = stopWriter;
+            TakeEvents(text);
+            lock.unlock();
+            if (!text.empty()) {
+                (void)fwrite(text.data(), 1, text.size(), file);
+                (void)fflush(file);
+                text.clear();
+            }
+            lock.lock();
+            if (stopping) {
+                break;
+            }
+        }
+    }
+};
+
+Tracer::~Tracer() noexcept {
+    Close();
+}
+
+Tracer::Tracer()
+    : impl_(new Impl())
+{
+}
+
+bool Tracer::Open(const std::string& path) {
+    Close();
+    impl_->file = fopen(path.c_str(), "wb");
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    (void)fputs("[", impl_->file);
+    impl_->firstEvent = true;
+    impl_->stopWriter = false;
+    impl_->startTime = std::chrono::steady_clock::now();
+    impl_->writerThread = std::thread(&Impl::Writer, impl_.get());
+    impl_->enabled = true;
+    return true;
+}
+
+void Tracer::Close() {
+    if (impl_->file == nullptr) {
+        return;
+    }
+    impl_->enabled = false;
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->stopWriter = true;
+        impl_->writerWakeCondition.notify_all();
+    }
+    impl_->writerThread.join();
+    (void)fputs("\n]\n", impl_->file);
+    (void)fclose(impl_->file);
+    impl_->file = nullptr;
+}
+
+void Tracer::NameThread(const char* name) {
+    impl_->Record('M', "thread_name", name, 0);
+}
+
+void Tracer::Begin(const char* name) {
+    impl_->Record('B', name, nullptr, 0);
+}
+
+void Tracer::End(const char* name) {
+    impl_->Record('E', name, nullptr, 0);
+}
+
+void Tracer::Instant(const char* name) {
+    impl_->Record('i', name, nullptr, 0);
+}
+
+void Tracer::AsyncBegin(
+    const char* name,
+    uint64_t id
+) {
+    impl_->Record('b', name, nullptr, id);
+}
+
+void Tracer::AsyncStep(
+    const char* name,
+    const char* step,
+    uint64_t id
+) {
+    impl_->Record('n', name, step, id);
+}
+
+void Tracer::AsyncEnd(
+    const char* name,
+    uint64_t id
+) {
+    impl_->Record('e', name, nullptr, id);
+}
+
+TraceSpan::~TraceSpan() noexcept {
+    tracer_.End(name_);
+}
+
+TraceSpan::TraceSpan(
+    Tracer& tracer,
+    const char* name
+)
+    : tracer_(tracer)
+    , name_(name)
+{
+    tracer_.Begin(name_);
+}
@@ -0,0 +1,216 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+/**
+ * @file Tracer.hpp
+ *
+ * This module declares the Tracer and TraceSpan implementations.
+ *
+ * A trace is a file of timestamped events in the Chrome trace-event
+ * JSON format, which can be opened in a trace viewer (such as
+ * chrome://tracing or Perfetto) to see what each thread was doing
+ * and when.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+/**
+ * This records timestamped events to a trace file.  Each thread
+ * records events into a ring buffer of its own, without locking,
+ * and a background thread takes the events from the ring buffers and
+ * writes them to the file.  While the tracer isn't open, recording
+ * an event does nothing but check a flag.
+ *
+ * Every name given to the tracer must be a string literal (or otherwise
+ * outlive the tracer), since only the pointer is kept until the event
+ * is written, and must not contain any characters which would need
+ * to be escaped in JSON.
+ *
+ * If a thread records events faster than they're written, events which
+ * don't fit in its ring buffer are dropped, and the number dropped
+ * is recorded in the trace as a counter.
+ */
+class Tracer {
+    // Lifecycle Methods
+public:
+    ~Tracer() noexcept;
+    Tracer(const Tracer&) = delete;
+    Tracer(Tracer&&) noexcept = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    Tracer& operator=(Tracer&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    Tracer();
+
+    /**
+     * This method creates (or replaces) the given trace file,
+     * starts the background writer, and starts recording events.
+     *
+     * @param[in] path
+     *     This is the path of the trace file to create.
+     *
+     * @return
+     *     An indication of whether or not the file was created
+     *     is returned.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * This method stops recording events, writes out any events
+     * not yet written, stops the background writer, and closes
+     * the trace file.
+     */
+    void Close();
+
+    /**
+     * This method names the calling thread in the trace.
+     *
+     * @param[in] name
+     *     This is the name to give the calling thread.
+     */
+    void NameThread(const char* name);
+
+    /**
+     * This method records the beginning of a span of time
+     * on the calling thread.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     */
+    void Begin(const char* name);
+
+    /**
+     * This method records the end of the span of time on the calling
+     * thread which was most recently begun and hasn't yet ended.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     */
+    void End(const char* name);
+
+    /**
+     * This method records something which happened at one instant
+     * on the calling thread.
+     *
+     * @param[in] name
+     *     This is the name of the event.
+     */
+    void Instant(const char* name);
+
+    /**
+     * This method records the beginning of a span of time which
+     * isn't tied to any one thread, such as a question/answer round.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     *
+     * @param[in] id
+     *     This identifies the span among all spans with the same name
+     *     which are in progress at the same time.
+     */
+    void AsyncBegin(
+        const char* name,
+        uint64_t id
+    );
+
+    /**
+     * This method records something which happened at one instant
+     * during a span of time begun by AsyncBegin.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     *
+     * @param[in] step
+     *     This is the name of what happened.
+     *
+     * @param[in] id
+     *     This identifies the span among all spans with the same name
+     *     which are in progress at the same time.
+     */
+    void AsyncStep(
+        const char* name,
+        const char* step,
+        uint64_t id
+    );
+
+    /**
+     * This method records the end of a span of time begun by AsyncBegin.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     *
+     * @param[in] id
+     *     This identifies the span among all spans with the same name
+     *     which are in progress at the same time.
+     */
+    void AsyncEnd(
+        const char* name,
+        uint64_t id
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+/**
+ * This records a span of time on the calling thread, from when
+ * it's constructed until it's destroyed.
+ */
+class TraceSpan {
+    // Lifecycle Methods
+public:
+    ~TraceSpan() noexcept;
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan(TraceSpan&&) noexcept = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    TraceSpan& operator=(TraceSpan&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in,out] tracer
+     *     This is the tracer to which to record the span.
+     *
+     * @param[in] name
+     *     This is the name of the span.
+     */
+    TraceSpan(
+        Tracer& tracer,
+        const char* name
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the tracer to which the span is recorded.
+     */
+    Tracer& tracer_;
+
+    /**
+     * This is the name of the span.
+     */
+    const char* name_;
+};
+
+#endif /* TRACER_HPP */
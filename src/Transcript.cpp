@@ -0,0 +1,455 @@
+/**
+ * @file Transcript.cpp
+ *
+ * This module contains the implementations of the TranscriptRecorder
+ * and TranscriptReader classes.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "Serialization.hpp"
+#include "Transcript.hpp"
+
+#include <condition_variable>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the bytes which begin every transcript segment.
+     */
+    constexpr uint8_t SEGMENT_MAGIC[] = {'M', 'B', 'T', 'R'};
+
+    /**
+     * This is the version of the transcript format written
+     * by this module.
+     */
+    constexpr uint8_t FORMAT_VERSION = 1;
+
+    /**
+     * This is the number of milliseconds the background writer
+     * waits between writes, if not woken up earlier.
+     */
+    constexpr unsigned int WRITER_PERIOD_MILLISECONDS = 250;
+
+    /**
+     * This is the number of encoded bytes which, once pending,
+     * causes the background writer to be woken up early.
+     */
+    constexpr size_t WRITER_WAKE_THRESHOLD = 65536;
+
+    /**
+     * This is the number of encoded bytes after which a new segment
+     * is started, so that the dictionaries (which are kept in memory
+     * for as long as their segment is open) stay bounded.
+     */
+    constexpr size_t SEGMENT_MAX_BYTES = 16 * 1048576;
+
+    /**
+     * This is the number of milliseconds after which a new segment
+     * is started, so that the dictionaries only ever hold recent
+     * nicknames and channels.
+     */
+    constexpr int64_t SEGMENT_MAX_MILLISECONDS = 3600 * 1000;
+
+    /**
+     * These are the kinds of records which follow a segment header.
+     */
+    enum class RecordType : uint8_t {
+        /**
+         * This adds the following string to the nickname dictionary.
+         */
+        Nickname = 1,
+
+        /**
+         * This adds the following string to the channel dictionary.
+         */
+        Channel = 2,
+
+        /**
+         * This holds one chat message.
+         */
+        Message = 3,
+    };
+
+}
+
+/**
+ * This contains the private properties of a TranscriptRecorder
+ * class instance.
+ */
+struct TranscriptRecorder::Impl {
+    // Properties
+
+    /**
+     * This is the transcript file, or nullptr if not open.
+     */
+    FILE* file = nullptr;
+
+    /**
+     * This is used to synchronize access to the object.
+     */
+    std::mutex mutex;
+
+    /**
+     * This is used to wake up the background writer.
+     */
+    std::condition_variable writerWakeCondition;
+
+    /**
+     * This is the thread which writes encoded messages to the file.
+     */
+    std::thread writerThread;
+
+    /**
+     * This flag indicates whether or not the background writer
+     * should stop once everything pending has been written.
+     */
+    bool stopWriter = false;
+
+    /**
+     * This flag indicates whether or not writing to the file
+     * has failed.  Once set, nothing more is written.
+     */
+    bool writeFailed = false;
+
+    /**
+     * This holds the encoded records not yet handed
+     * to the background writer.
+     */
+    std::vector< uint8_t > pending;
+
+    /**
+     * This maps each nickname already in the current segment's
+     * dictionary to its index.
+     */
+    std::unordered_map< std::string, uint64_t > nicknames;
+
+    /**
+     * This maps each channel already in the current segment's
+     * dictionary to its index.
+     */
+    std::unordered_map< std::string, uint64_t > channels;
+
+    /**
+     * This is the time, in milliseconds, of the last message recorded.
+     */
+    int64_t lastTimeMilliseconds = 0;
+
+    /**
+     * This is the time, in milliseconds, of the first message
+     * recorded in the current segment.
+     */
+    int64_t segmentStartMilliseconds = 0;
+
+    /**
+     * This is the number of bytes encoded in the current segment,
+     * or zero if no segment has been started since the file was opened.
+     */
+    size_t segmentBytes = 0;
+
+    // Methods
+
+    /**
+     * This method appends a segment header, and resets the
+     * dictionaries and the other state carried between records.
+     *
+     * @param[in] timeMilliseconds
+     *     This is the time, in milliseconds, of the first message
+     *     to be recorded in the new segment.
+     */
+    void StartSegment(int64_t timeMilliseconds) {
+        nicknames.clear();
+        channels.clear();
+        lastTimeMilliseconds = 0;
+        segmentStartMilliseconds = timeMilliseconds;
+        const auto headerStart = pending.size();
+        pending.insert(pending.end(), SEGMENT_MAGIC, SEGMENT_MAGIC + sizeof(SEGMENT_MAGIC));
+        pending.push_back(FORMAT_VERSION);
+        segmentBytes = pending.size() - headerStart;
+    }
+
+    /**
+     * This method returns the dictionary index of the given string,
+     * first appending a record to add it to the dictionary
+     * if it isn't already there.
+     *
+     * @param[in,out] dictionary
+     *     This is the dictionary in which to look up the string.
+     *
+     * @param[in] type
+     *     This is the kind of record which adds a string
+     *     to the dictionary.
+     *
+     * @param[in] value
+     *     This is the string to look up.
+     *
+     * @return
+     *     The dictionary index of the string is returned.
+     */
+    uint64_t Intern(
+        std::unordered_map< std::string, uint64_t >& dictionary,
+        RecordType type,
+        const std::string& value
+    ) {
+        const auto entry = dictionary.find(value);
+        if (entry != dictionary.end()) {
+            return entry->second;
+        }
+        const auto index = (uint64_t)dictionary.size();
+        dictionary[value] = index;
+        pending.push_back((uint8_t)type);
+        AppendString(pending, value);
+        return index;
+    }
+
+    /**
+     * This function is called in a separate thread to write
+     * encoded records to the file.
+     */
+    void Writer() {
+        std::vector< uint8_t > batch;
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        for (;;) {
+            writerWakeCondition.wait_for(
+                lock,
+                std::chrono::milliseconds(WRITER_PERIOD_MILLISECONDS),
+                [this]{
+                    return (
+                        stopWriter
+                        || (pending.size() >= WRITER_WAKE_THRESHOLD)
+                    );
+                }
+            );
+            const auto stopping = stopWriter;
+            batch.swap(pending);
+            lock.unlock();
+            auto written = true;
+            if (!batch.empty()) {
+                written = (
+                    (fwrite(batch.data(), 1, batch.size(), file) == batch.size())
+                    && (fflush(file) == 0)
+                );
+                batch.clear();
+            }
+            lock.lock();
+            if (!written) {
+                writeFailed = true;
+                pending.clear();
+            }
+            if (stopping) {
+                break;
+            }
+        }
+    }
+};
+
+TranscriptRecorder::~TranscriptRecorder() noexcept {
+    (void)Close();
+}
+
+TranscriptRecorder::TranscriptRecorder()
+    : impl_(new Impl())
+{
+}
+
+bool TranscriptRecorder::Open(const std::string& path) {
+    (void)Close();
+    impl_->file = fopen(path.c_str(), "ab");
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    impl_->pending.clear();
+    impl_->segmentBytes = 0;
+    impl_->stopWriter = false;
+    impl_->writeFailed = false;
+    impl_->writerThread = std::thread(&Impl::Writer, impl_.get());
+    return true;
+}
+
+bool TranscriptRecorder::Close() {
+    if (!impl_->writerThread.joinable()) {
+        return true;
+    }
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->stopWriter = true;
+        impl_->writerWakeCondition.notify_all();
+    }
+    impl_->writerThread.join();
+    const auto written = !impl_->writeFailed;
+    const auto closed = (fclose(impl_->file) == 0);
+    impl_->file = nullptr;
+    return written && closed;
+}
+
+bool TranscriptRecorder::Record(
+    double time,
+    const std::string& nickname,
+    const std::string& channel,
+    const std::string& msgId,
+    const std::string& content
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (impl_->file == nullptr) {
+        return true;
+    }
+    if (impl_->writeFailed) {
+        return false;
+    }
+    const auto timeMilliseconds = (int64_t)llround(time * 1000.0);
+    if (
+        (impl_->segmentBytes == 0)
+        || (impl_->segmentBytes >= SEGMENT_MAX_BYTES)
+        || (timeMilliseconds - impl_->segmentStartMilliseconds >= SEGMENT_MAX_MILLISECONDS)
+    ) {
+        impl_->StartSegment(timeMilliseconds);
+    }
+    const auto pendingStart = impl_->pending.size();
+    const auto nicknameIndex = impl_->Intern(impl_->nicknames, RecordType::Nickname, nickname);
+    const auto channelIndex = impl_->Intern(impl_->channels, RecordType::Channel, channel);
+    impl_->pending.push_back((uint8_t)RecordType::Message);
+    AppendVarint(impl_->pending, ZigZagEncode(timeMilliseconds - impl_->lastTimeMilliseconds));
+    AppendVarint(impl_->pending, nicknameIndex);
+    AppendVarint(impl_->pending, channelIndex);
+    AppendString(impl_->pending, msgId);
+    AppendString(impl_->pending, content);
+    impl_->lastTimeMilliseconds = timeMilliseconds;
+    impl_->segmentBytes += impl_->pending.size() - pendingStart;
+    if (impl_->pending.size() >= WRITER_WAKE_THRESHOLD) {
+        impl_->writerWakeCondition.notify_all();
+    }
+    return true;
+}
+
+/**
+ * This contains the private properties of a TranscriptReader
+ * class instance.
+ */
+struct TranscriptReader::Impl {
+    // Properties
+
+    /**
+     * This is the transcript file, or nullptr if not open.
+     */
+    FILE* file = nullptr;
+
+    /**
+     * This is the nickname dictionary of the current segment.
+     */
+    std::vector< std::string > nicknames;
+
+    /**
+     * This is the channel dictionary of the current segment.
+     */
+    std::vector< std::string > channels;
+
+    /**
+     * This is the time, in milliseconds, of the last message read.
+     */
+    int64_t lastTimeMilliseconds = 0;
+
+    // Methods
+
+    /**
+     * This method reads the remainder of a segment header, after
+     * its first byte, and resets the state carried between records.
+     *
+     * @return
+     *     An indication of whether or not a valid header was read
+     *     is returned.
+     */
+    bool ReadRestOfSegmentHeader() {
+        for (size_t i = 1; i < sizeof(SEGMENT_MAGIC); ++i) {
+            if (getc(file) != SEGMENT_MAGIC[i]) {
+                return false;
+            }
+        }
+        if (getc(file) != FORMAT_VERSION) {
+            return false;
+        }
+        nicknames.clear();
+        channels.clear();
+        lastTimeMilliseconds = 0;
+        return true;
+    }
+};
+
+TranscriptReader::~TranscriptReader() noexcept {
+    if (impl_->file != nullptr) {
+        (void)fclose(impl_->file);
+    }
+}
+
+TranscriptReader::TranscriptReader()
+    : impl_(new Impl())
+{
+}
+
+bool TranscriptReader::Open(const std::string& path) {
+    if (impl_->file != nullptr) {
+        (void)fclose(impl_->file);
+    }
+    impl_->file = fopen(path.c_str(), "rb");
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    return (
+        (getc(impl_->file) == SEGMENT_MAGIC[0])
+        && impl_->ReadRestOfSegmentHeader()
+    );
+}
+
+bool TranscriptReader::Next(TranscriptEntry& entry) {
+    if (impl_->file == nullptr) {
+        return false;
+    }
+    for (;;) {
+        const auto type = getc(impl_->file);
+        if (type == EOF) {
+            return false;
+        } else if (type == SEGMENT_MAGIC[0]) {
+            if (!impl_->ReadRestOfSegmentHeader()) {
+                return false;
+            }
+        } else if (type == (int)RecordType::Nickname) {
+            std::string nickname;
+            if (!ReadString(impl_->file, nickname)) {
+                return false;
+            }
+            impl_->nicknames.push_back(std::move(nickname));
+        } else if (type == (int)RecordType::Channel) {
+            std::string channel;
+            if (!ReadString(impl_->file, channel)) {
+                return false;
+            }
+            impl_->channels.push_back(std::move(channel));
+        } else if (type == (int)RecordType::Message) {
+            uint64_t timeDelta, nicknameIndex, channelIndex;
+            if (
+                !ReadVarint(impl_->file, timeDelta)
+                || !ReadVarint(impl_->file, nicknameIndex)
+                || !ReadVarint(impl_->file, channelIndex)
+                || (nicknameIndex >= impl_->nicknames.size())
+                || (channelIndex >= impl_->channels.size())
+                || !ReadString(impl_->file, entry.msgId)
+                || !ReadString(impl_->file, entry.content)
+            ) {
+                return false;
+            }
+            impl_->lastTimeMilliseconds += ZigZagDecode(timeDelta);
+            entry.time = (double)impl_->lastTimeMilliseconds / 1000.0;
+            entry.nickname = impl_->nicknames[(size_t)nicknameIndex];
+            entry.channel = impl_->channels[(size_t)channelIndex];
+            return true;
+        } else {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,210 @@
+#ifndef TRANSCRIPT_HPP
+#define TRANSCRIPT_HPP
+
+/**
+ * @file Transcript.hpp
+ *
+ * This module declares the TranscriptRecorder and TranscriptReader
+ * implementations.
+ *
+ * A transcript is a compact binary log of chat messages.  It consists
+ * of one or more segments, each of which begins with a header and is
+ * followed by records.  Within a segment, nicknames and channels are
+ * dictionary-encoded (each distinct string is written once and referred
+ * to afterwards by index), timestamps are delta-encoded against the
+ * previous message, and all integers and string lengths are written
+ * as variable-length quantities.  A new segment is started once
+ * the current one grows large or old enough, so that the dictionaries
+ * held in memory while recording stay bounded.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <string>
+
+/**
+ * This holds one chat message as stored in a transcript.
+ */
+struct TranscriptEntry {
+    /**
+     * This is the time (according to the time keeper) when
+     * the message was received.
+     */
+    double time = 0.0;
+
+    /**
+     * This is the nickname of the user who sent the message.
+     */
+    std::string nickname;
+
+    /**
+     * This is the channel to which the message was sent.
+     */
+    std::string channel;
+
+    /**
+     * This is the `id` tag of the message.
+     */
+    std::string msgId;
+
+    /**
+     * This is the content of the message.
+     */
+    std::string content;
+};
+
+/**
+ * This appends chat messages to a transcript file.  Messages are
+ * encoded in the calling thread, and written to the file in batches
+ * by a background thread, so that recording a message never waits
+ * on the file system.
+ */
+class TranscriptRecorder {
+    // Lifecycle Methods
+public:
+    ~TranscriptRecorder() noexcept;
+    TranscriptRecorder(const TranscriptRecorder&) = delete;
+    TranscriptRecorder(TranscriptRecorder&&) noexcept = delete;
+    TranscriptRecorder& operator=(const TranscriptRecorder&) = delete;
+    TranscriptRecorder& operator=(TranscriptRecorder&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    TranscriptRecorder();
+
+    /**
+     * This method opens the given transcript file for appending,
+     * starts a new segment in it, and starts the background writer.
+     *
+     * @param[in] path
+     *     This is the path of the transcript file to open.
+     *
+     * @return
+     *     An indication of whether or not the file was opened
+     *     is returned.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * This method writes out any messages not yet written,
+     * stops the background writer, and closes the transcript file.
+     *
+     * @return
+     *     An indication of whether or not every message recorded
+     *     was written to the file is returned.
+     */
+    bool Close();
+
+    /**
+     * This method appends the given message to the transcript.
+     * It does nothing if the transcript is not open.
+     *
+     * @param[in] time
+     *     This is the time (according to the time keeper) when
+     *     the message was received.
+     *
+     * @param[in] nickname
+     *     This is the nickname of the user who sent the message.
+     *
+     * @param[in] channel
+     *     This is the channel to which the message was sent.
+     *
+     * @param[in] msgId
+     *     This is the `id` tag of the message.
+     *
+     * @param[in] content
+     *     This is the content of the message.
+     *
+     * @return
+     *     An indication of whether or not the transcript is still
+     *     being recorded is returned.  This is false once writing
+     *     to the file has failed, after which nothing more is recorded.
+     */
+    bool Record(
+        double time,
+        const std::string& nickname,
+        const std::string& channel,
+        const std::string& msgId,
+        const std::string& content
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+/**
+ * This streams chat messages back out of a transcript file,
+ * one at a time, in the order they were recorded.
+ */
+class TranscriptReader {
+    // Lifecycle Methods
+public:
+    ~TranscriptReader() noexcept;
+    TranscriptReader(const TranscriptReader&) = delete;
+    TranscriptReader(TranscriptReader&&) noexcept = delete;
+    TranscriptReader& operator=(const TranscriptReader&) = delete;
+    TranscriptReader& operator=(TranscriptReader&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    TranscriptReader();
+
+    /**
+     * This method opens the given transcript file for reading.
+     *
+     * @param[in] path
+     *     This is the path of the transcript file to open.
+     *
+     * @return
+     *     An indication of whether or not the file was opened
+     *     and begins with a valid segment header is returned.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * This method reads the next message from the transcript.
+     *
+     * @param[out] entry
+     *     This is where to store the message read.
+     *
+     * @return
+     *     An indication of whether or not a message was read is returned.
+     *     This is false at the end of the transcript, or if the
+     *     transcript is truncated or corrupt.
+     */
+    bool Next(TranscriptEntry& entry);
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* TRANSCRIPT_HPP */
@@ -20,6 +20,7 @@
 #include <SystemAbstractions/DiagnosticsStreamReporter.hpp>
 #include <SystemAbstractions/File.hpp>
 #include <thread>
+#include <vector>
 
 namespace {
 
@@ -31,13 +32,34 @@ namespace {
         fprintf(
             stderr,
             (
-                "Usage: MathBot2001 TOKEN CHANNEL [NICK]\n"
+                "Usage: MathBot2001 [OPTIONS] TOKEN CHANNEL [NICK]\n"
                 "\n"
                 "Connect to Twitch chat and listen for messages.\n"
                 "\n"
                 "  TOKEN   Path/name of file containing the OAuth token to use\n"
-                "  CHANNEL Name of the Twitch channel to join\n"
+                "  CHANNEL Name of the Twitch channel to join, or names of\n"
+                "          several channels separated by commas\n"
                 "  NICK    Nickname (username) to use (default: MathBot2001)\n"
+                "\n"
+                "Options:\n"
+                "  --export-scores PATH  Write the points of every contestant\n"
+                "                        to the score file at PATH when exiting\n"
+                "  --import-scores PATH  Add the points of the contestants in\n"
+                "                        the score file at PATH before joining\n"
+                "  --questions COUNT     Allow up to COUNT questions to be open\n"
+                "                        at once in each channel, asking them\n"
+                "                        COUNT times as often (default: 1,\n"
+                "                        at most 16)\n"
+                "  --snapshot PATH       Restore the state of the bot from the\n"
+                "                        file at PATH, if it exists, and save\n"
+                "                        it there when exiting\n"
+                "  --trace PATH          Record a timeline of each round to the\n"
+                "                        Chrome trace-event JSON file at PATH\n"
+                "  --transcript PATH     Append all chat messages received\n"
+                "                        to the binary transcript file at PATH\n"
+                "\n"
+                "Score files whose names end in \".csv\" are comma-separated\n"
+                "values; all others are in a compact binary format.\n"
             )
         );
     }
@@ -58,16 +80,82 @@ namespace {
         std::string token;
 
         /**
-         * This is the name of the channel to join in Twitch.
+         * These are the names of the channels to join in Twitch.
          */
-        std::string channel;
+        std::vector< std::string > channels;
 
         /**
          * This is the nickname to use on Twitch.
          */
         std::string nickname = "MathBot2001";
+
+        /**
+         * This is the path of the file to which to record chat messages,
+         * or an empty string if chat messages should not be recorded.
+         */
+        std::string transcriptPath;
+
+        /**
+         * This is the path of the file to which to record a timeline
+         * of each round, or an empty string if no timeline
+         * should be recorded.
+         */
+        std::string tracePath;
+
+        /**
+         * This is the path of the file from which to restore, and to which
+         * to save, the state of the bot, or an empty string if the state
+         * of the bot should not be saved.
+         */
+        std::string snapshotPath;
+
+        /**
+         * This is the largest number of questions which may be open
+         * at once in each channel.
+         */
+        size_t maxOpenQuestions = 1;
+
+        /**
+         * This is the path of the score file from which to add points
+         * to contestants, or an empty string if no scores
+         * should be imported.
+         */
+        std::string importScoresPath;
+
+        /**
+         * This is the path of the score file to which to write the points
+         * of every contestant when exiting, or an empty string if no scores
+         * should be exported.
+         */
+        std::string exportScoresPath;
     };
 
+    /**
+     * This function determines the format of a score file from its name.
+     *
+     * @param[in] path
+     *     This is the path of the score file.
+     *
+     * @return
+     *     The format of the score file is returned.
+     */
+    ScoreFileFormat GetScoreFileFormat(const std::string& path) {
+        const std::string csvExtension = ".csv";
+        if (
+            (path.length() >= csvExtension.length())
+            && (
+                StringExtensions::ToLower(
+                    path.substr(path.length() - csvExtension.length())
+                )
+                == csvExtension
+            )
+        ) {
+            return ScoreFileFormat::Csv;
+        } else {
+            return ScoreFileFormat::Binary;
+        }
+    }
+
     /**
      * This function is set up to be called when the SIGINT signal is
      * received by the program.  It just sets the "shutDown" flag
@@ -113,8 +201,65 @@ namespace {
             Done,
         } state = State::Token;
         std::string tokenFilePath;
+        std::string option;
         for (int i = 1; i < argc; ++i) {
             const std::string arg(argv[i]);
+            if (!option.empty()) {
+                if (option == "--transcript") {
+                    environment.transcriptPath = arg;
+                } else if (option == "--trace") {
+                    environment.tracePath = arg;
+                } else if (option == "--snapshot") {
+                    environment.snapshotPath = arg;
+                } else if (option == "--questions") {
+                    intmax_t maxOpenQuestions;
+                    if (
+                        (
+                            StringExtensions::ToInteger(arg, maxOpenQuestions)
+                            != StringExtensions::ToIntegerResult::Success
+                        )
+                        || (maxOpenQuestions < 1)
+                        || ((uintmax_t)maxOpenQuestions > MathBot2001::MAX_OPEN_QUESTIONS)
+                    ) {
+                        diagnosticMessageDelegate(
+                            "MathBot2001",
+                            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                            StringExtensions::sprintf(
+                                "invalid question count '%s'",
+                                arg.c_str()
+                            )
+                        );
+                        return false;
+                    }
+                    environment.maxOpenQuestions = (size_t)maxOpenQuestions;
+                } else if (option == "--import-scores") {
+                    environment.importScoresPath = arg;
+                } else if (option == "--export-scores") {
+                    environment.exportScoresPath = arg;
+                }
+                option.clear();
+                continue;
+            } else if (
+                (arg == "--transcript")
+                || (arg == "--trace")
+                || (arg == "--snapshot")
+                || (arg == "--questions")
+                || (arg == "--import-scores")
+                || (arg == "--export-scores")
+            ) {
+                option = arg;
+                continue;
+            } else if (arg.substr(0, 2) == "--") {
+                diagnosticMessageDelegate(
+                    "MathBot2001",
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    StringExtensions::sprintf(
+                        "unknown option '%s'",
+                        arg.c_str()
+                    )
+                );
+                return false;
+            }
             switch (state) {
                 case State::Token: {
                     tokenFilePath = arg;
@@ -122,7 +267,11 @@ namespace {
                 } break;
 
                 case State::Channel: {
-                    environment.channel = arg;
+                    for (const auto& channel: StringExtensions::Split(arg, ',')) {
+                        if (!channel.empty()) {
+                            environment.channels.push_back(channel);
+                        }
+                    }
                     state = State::Nickname;
                 } break;
 
@@ -135,14 +284,27 @@ namespace {
                 } break;
             }
         }
-        if (state == State::Token) {
+        if (!option.empty()) {
+            diagnosticMessageDelegate(
+                "MathBot2001",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                StringExtensions::sprintf(
+                    "no value given for option '%s'",
+                    option.c_str()
+                )
+            );
+            return false;
+        } else if (state == State::Token) {
             diagnosticMessageDelegate(
                 "MathBot2001",
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "no token path name given"
             );
             return false;
-        } else if (state == State::Channel) {
+        } else if (
+            (state == State::Channel)
+            || environment.channels.empty()
+        ) {
             diagnosticMessageDelegate(
                 "MathBot2001",
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
@@ -209,9 +371,69 @@ int main(int argc, char* argv[]) {
     }
     const auto bot = std::make_shared< MathBot2001 >();
     bot->Configure(diagnosticsPublisher);
+    if (
+        !environment.transcriptPath.empty()
+        && !bot->RecordTranscript(environment.transcriptPath)
+    ) {
+        diagnosticsPublisher(
+            "MathBot2001",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to open transcript file '%s'",
+                environment.transcriptPath.c_str()
+            )
+        );
+        return EXIT_FAILURE;
+    }
+    if (
+        !environment.tracePath.empty()
+        && !bot->RecordTrace(environment.tracePath)
+    ) {
+        diagnosticsPublisher(
+            "MathBot2001",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to create trace file '%s'",
+                environment.tracePath.c_str()
+            )
+        );
+        return EXIT_FAILURE;
+    }
+    if (
+        !environment.snapshotPath.empty()
+        && !bot->UseSnapshot(environment.snapshotPath)
+    ) {
+        diagnosticsPublisher(
+            "MathBot2001",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to restore snapshot file '%s'",
+                environment.snapshotPath.c_str()
+            )
+        );
+        return EXIT_FAILURE;
+    }
+    if (
+        !environment.importScoresPath.empty()
+        && !bot->ImportScores(
+            environment.importScoresPath,
+            GetScoreFileFormat(environment.importScoresPath)
+        )
+    ) {
+        diagnosticsPublisher(
+            "MathBot2001",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to import score file '%s'",
+                environment.importScoresPath.c_str()
+            )
+        );
+        return EXIT_FAILURE;
+    }
+    bot->SetMaxOpenQuestions(environment.maxOpenQuestions);
     bot->InitiateLogIn(
         environment.token,
-        environment.channel,
+        environment.channels,
         environment.nickname
     );
     while (!shutDown) {
@@ -222,5 +444,22 @@ int main(int argc, char* argv[]) {
     (void)signal(SIGINT, previousInterruptHandler);
     bot->InitiateLogOut();
     bot->AwaitLogOut();
+    if (
+        !environment.exportScoresPath.empty()
+        && !bot->ExportScores(
+            environment.exportScoresPath,
+            GetScoreFileFormat(environment.exportScoresPath)
+        )
+    ) {
+        diagnosticsPublisher(
+            "MathBot2001",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to export score file '%s'",
+                environment.exportScoresPath.c_str()
+            )
+        );
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,74 @@
+/**
+ * @file AnswerEvaluatorTests.cpp
+ *
+ * This module contains the unit tests of the functions used to evaluate
+ * the answers users give to math questions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <AnswerEvaluator.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(AnswerEvaluatorTests, NumbersNormalized) {
+    struct TestVector {
+        std::string text;
+        intmax_t numerator;
+        intmax_t denominator;
+    };
+    const std::vector< TestVector > testVectors{
+        {"42", 42, 1},
+        {" 42", 42, 1},
+        {"042", 42, 1},
+        {"42.0", 42, 1},
+        {"84/2", 42, 1},
+        {"-7", -7, 1},
+        {"0.5", 1, 2},
+        {"6/4", 3, 2},
+    };
+    for (const auto& testVector: testVectors) {
+        AnswerValue value;
+        ASSERT_TRUE(EvaluateAnswer(testVector.text, AnswerSyntax::Number, value)) << testVector.text;
+        EXPECT_EQ(testVector.numerator, value.numerator) << testVector.text;
+        EXPECT_EQ(testVector.denominator, value.denominator) << testVector.text;
+    }
+}
+
+TEST(AnswerEvaluatorTests, ExpressionsOnlyAcceptedWhenAsked) {
+    AnswerValue value;
+    EXPECT_FALSE(EvaluateAnswer("6 * 7", AnswerSyntax::Number, value));
+    ASSERT_TRUE(EvaluateAnswer("6 * 7", AnswerSyntax::Expression, value));
+    EXPECT_EQ(42, value.numerator);
+    EXPECT_EQ(1, value.denominator);
+    ASSERT_TRUE(EvaluateAnswer("(1 + 2) / 4", AnswerSyntax::Expression, value));
+    EXPECT_EQ(3, value.numerator);
+    EXPECT_EQ(4, value.denominator);
+}
+
+TEST(AnswerEvaluatorTests, BadAnswersRejected) {
+    AnswerValue value;
+    EXPECT_FALSE(EvaluateAnswer("", AnswerSyntax::Number, value));
+    EXPECT_FALSE(EvaluateAnswer("-", AnswerSyntax::Number, value));
+    EXPECT_FALSE(EvaluateAnswer("forty-two", AnswerSyntax::Number, value));
+    EXPECT_FALSE(EvaluateAnswer("1/0", AnswerSyntax::Number, value));
+    EXPECT_FALSE(EvaluateAnswer("99999999999999999999999", AnswerSyntax::Number, value));
+}
+
+TEST(AnswerEvaluatorTests, FastPathAgreesWithParser) {
+    const std::vector< std::string > answers{
+        "42", " 137 ", "7", "1000", "-5", "0", "-0", "007",
+        "123456789012345678", "-123456789012345678",
+        "9223372036854775807", "42.0", "84/2", "", "-", "4 2", "+4",
+    };
+    for (const auto& answer: answers) {
+        AnswerValue fastValue, parsedValue;
+        const auto fastAccepted = EvaluateAnswer(answer, AnswerSyntax::Number, fastValue);
+        const auto parsedAccepted = EvaluateAnswerWithoutFastPath(answer, AnswerSyntax::Number, parsedValue);
+        EXPECT_EQ(parsedAccepted, fastAccepted) << answer;
+        if (fastAccepted && parsedAccepted) {
+            EXPECT_EQ(parsedValue, fastValue) << answer;
+        }
+    }
+}
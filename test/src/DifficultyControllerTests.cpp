@@ -0,0 +1,50 @@
+/**
+ * @file DifficultyControllerTests.cpp
+ *
+ * This module contains the unit tests of the DifficultyController class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <DifficultyController.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+    /**
+     * This is the length, in seconds, of the rounds in these tests.
+     */
+    constexpr double ROUND_TIME = 15.0;
+
+}
+
+TEST(DifficultyControllerTests, RoundsWithNoAnswersMakeQuestionsEasier) {
+    DifficultyController controller;
+    const auto startingLevel = controller.GetLevel();
+    ASSERT_GT(startingLevel, 0);
+    for (int i = 0; i < startingLevel; ++i) {
+        controller.RecordRound(false, ROUND_TIME, 0, 0);
+        EXPECT_EQ(startingLevel - i - 1, controller.GetLevel());
+    }
+    controller.RecordRound(false, ROUND_TIME, 0, 0);
+    EXPECT_EQ(0, controller.GetLevel());
+}
+
+TEST(DifficultyControllerTests, QuickSolvesMakeQuestionsHarder) {
+    DifficultyController controller;
+    const auto startingLevel = controller.GetLevel();
+    for (int i = 0; i < 20; ++i) {
+        controller.RecordRound(true, 1.0, 1, 0);
+    }
+    EXPECT_GT(controller.GetLevel(), startingLevel);
+    EXPECT_LE(controller.GetLevel(), DifficultyController::MAX_LEVEL);
+}
+
+TEST(DifficultyControllerTests, SlowSolvesMakeQuestionsEasier) {
+    DifficultyController controller;
+    const auto startingLevel = controller.GetLevel();
+    for (int i = 0; i < 5; ++i) {
+        controller.RecordRound(true, ROUND_TIME - 1.0, 1, 0);
+    }
+    EXPECT_LT(controller.GetLevel(), startingLevel);
+}
@@ -0,0 +1,388 @@
+/**
+ * @file MathBot2001Tests.cpp
+ *
+ * This module contains the unit tests of the MathBot2001 class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <MathBot2001.hpp>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <Twitch/Connection.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the path of the snapshot file used by the tests.
+     */
+    const std::string TEST_SNAPSHOT_PATH = "MathBot2001Tests.snapshot";
+
+    /**
+     * This is the nickname the bot uses in the tests.
+     */
+    const std::string TEST_NICKNAME = "mathbot2001";
+
+    /**
+     * This is the channel the bot joins in the tests.
+     */
+    const std::string TEST_CHANNEL = "alpha";
+
+    /**
+     * This is how long to wait for anything expected to happen
+     * before failing a test.
+     */
+    constexpr auto TEST_TIMEOUT = std::chrono::seconds(5);
+
+    /**
+     * This is a stand-in for the Twitch chat server, which answers
+     * the bot's log-in and joins, and keeps the messages the bot sends.
+     * Messages from the server are delivered by a separate thread,
+     * as they would be by a real connection.
+     */
+    struct MockConnection
+        : public Twitch::Connection
+    {
+        // Properties
+
+        /**
+         * This is used to synchronize access to the object.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wait for the bot to send messages,
+         * and to wake the delivery thread.
+         */
+        std::condition_variable condition;
+
+        /**
+         * This is the function to call to deliver a message
+         * from the server to the bot.
+         */
+        MessageReceivedDelegate messageReceivedDelegate;
+
+        /**
+         * These are the messages from the server not yet delivered.
+         */
+        std::deque< std::string > toDeliver;
+
+        /**
+         * These are the chat messages the bot has sent.
+         */
+        std::vector< std::string > chatSent;
+
+        /**
+         * This flag indicates whether or not the delivery thread
+         * should stop.
+         */
+        bool stopDelivering = false;
+
+        /**
+         * This is the thread which delivers messages from the server.
+         */
+        std::thread deliveryThread;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         */
+        MockConnection() {
+            deliveryThread = std::thread(&MockConnection::Deliverer, this);
+        }
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~MockConnection() {
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stopDelivering = true;
+                condition.notify_all();
+            }
+            deliveryThread.join();
+        }
+
+        /**
+         * This method queues the given message to be delivered
+         * from the server to the bot.
+         *
+         * @param[in] message
+         *     This is the message to deliver.
+         */
+        void Deliver(const std::string& message) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            toDeliver.push_back(message + "\r\n");
+            condition.notify_all();
+        }
+
+        /**
+         * This method waits for the bot to have sent
+         * the given number of chat messages.
+         *
+         * @param[in] count
+         *     This is the number of chat messages to wait for.
+         *
+         * @return
+         *     An indication of whether or not the bot sent the given
+         *     number of chat messages before the timeout is returned.
+         */
+        bool AwaitChatSent(size_t count) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            return condition.wait_for(
+                lock,
+                TEST_TIMEOUT,
+                [this, count]{ return chatSent.size() >= count; }
+            );
+        }
+
+        /**
+         * This function is called in a separate thread to deliver
+         * messages from the server to the bot.
+         */
+        void Deliverer() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            while (!stopDelivering) {
+                if (
+                    toDeliver.empty()
+                    || (messageReceivedDelegate == nullptr)
+                ) {
+                    condition.wait(lock);
+                    continue;
+                }
+                const auto message = std::move(toDeliver.front());
+                toDeliver.pop_front();
+                const auto delegate = messageReceivedDelegate;
+                lock.unlock();
+                delegate(message);
+                lock.lock();
+            }
+        }
+
+        // Twitch::Connection
+
+        virtual void SetMessageReceivedDelegate(MessageReceivedDelegate messageReceivedDelegate) override {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            this->messageReceivedDelegate = messageReceivedDelegate;
+            condition.notify_all();
+        }
+
+        virtual void SetDisconnectedDelegate(DisconnectedDelegate disconnectedDelegate) override {
+        }
+
+        virtual bool Connect() override {
+            return true;
+        }
+
+        virtual void Disconnect() override {
+        }
+
+        virtual void Send(const std::string& message) override {
+            std::istringstream line(message);
+            std::string command, parameter;
+            line >> command >> parameter;
+            if (command == "NICK") {
+                Deliver(":tmi.twitch.tv 376 " + parameter + " :>");
+            } else if (command == "JOIN") {
+                Deliver(
+                    ":" + TEST_NICKNAME + "!" + TEST_NICKNAME + "@"
+                    + TEST_NICKNAME + ".tmi.twitch.tv JOIN " + parameter
+                );
+            } else if (command == "PRIVMSG") {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                chatSent.push_back(message);
+                condition.notify_all();
+            }
+        }
+    };
+
+    /**
+     * This returns the message the server sends when the bot
+     * joins or leaves the test channel.
+     *
+     * @param[in] command
+     *     This is either "JOIN" or "PART".
+     *
+     * @return
+     *     The message the server sends is returned.
+     */
+    std::string MembershipMessage(const std::string& command) {
+        return (
+            ":" + TEST_NICKNAME + "!" + TEST_NICKNAME + "@"
+            + TEST_NICKNAME + ".tmi.twitch.tv " + command + " #" + TEST_CHANNEL
+        );
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct MathBot2001Tests
+    : public ::testing::Test
+{
+    // Properties
+
+    /**
+     * This is the unit under test.
+     */
+    MathBot2001 bot;
+
+    /**
+     * This is the stand-in for the Twitch chat server.
+     */
+    std::shared_ptr< MockConnection > connection = std::make_shared< MockConnection >();
+
+    /**
+     * This is used to synchronize access to the diagnostic
+     * messages published by the bot.
+     */
+    std::mutex diagnosticsMutex;
+
+    /**
+     * This is used to wait for diagnostic messages.
+     */
+    std::condition_variable diagnosticsCondition;
+
+    /**
+     * These are the diagnostic messages published by the bot.
+     */
+    std::vector< std::string > diagnosticMessages;
+
+    /**
+     * If set, this is called (without holding diagnosticsMutex)
+     * with each diagnostic message published by the bot.
+     */
+    std::function< void(const std::string& message) > diagnosticHook;
+
+    // Methods
+
+    /**
+     * This method waits for the bot to publish the given
+     * diagnostic message.
+     *
+     * @param[in] message
+     *     This is the diagnostic message to wait for.
+     *
+     * @return
+     *     An indication of whether or not the bot published the given
+     *     diagnostic message before the timeout is returned.
+     */
+    bool AwaitDiagnostic(const std::string& message) {
+        std::unique_lock< decltype(diagnosticsMutex) > lock(diagnosticsMutex);
+        return diagnosticsCondition.wait_for(
+            lock,
+            TEST_TIMEOUT,
+            [this, message]{
+                for (const auto& diagnosticMessage: diagnosticMessages) {
+                    if (diagnosticMessage == message) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        );
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() {
+        (void)remove(TEST_SNAPSHOT_PATH.c_str());
+        bot.Configure(
+            [this](
+                std::string senderName,
+                size_t level,
+                std::string message
+            ){
+                {
+                    std::lock_guard< decltype(diagnosticsMutex) > lock(diagnosticsMutex);
+                    diagnosticMessages.push_back(message);
+                    diagnosticsCondition.notify_all();
+                }
+                if (diagnosticHook != nullptr) {
+                    diagnosticHook(message);
+                }
+            }
+        );
+        const auto connection = this->connection;
+        bot.SetConnectionFactory(
+            [connection]() -> std::shared_ptr< Twitch::Connection > {
+                return connection;
+            }
+        );
+    }
+
+    virtual void TearDown() {
+        (void)remove(TEST_SNAPSHOT_PATH.c_str());
+    }
+};
+
+TEST_F(MathBot2001Tests, LeavingWhileSendingQuestionStartsNoRound) {
+    // Leave the channel while the bot is sending its first question,
+    // then rejoin, so that the first question would be scored as a
+    // stale round after the rejoin if the sender started it anyway.
+    std::string firstQuestion;
+    const auto askingPrefix = "Asking in " + TEST_CHANNEL + ": What is ";
+    diagnosticHook = [this, &firstQuestion, askingPrefix](const std::string& message){
+        if (
+            !firstQuestion.empty()
+            || (message.compare(0, askingPrefix.length(), askingPrefix) != 0)
+        ) {
+            return;
+        }
+        // This is called by the sender thread, after it lets go
+        // of the bot's state but before it sends the question.
+        firstQuestion = message.substr(
+            askingPrefix.length(),
+            message.length() - askingPrefix.length() - 1
+        );
+        connection->Deliver(MembershipMessage("PART"));
+        EXPECT_TRUE(AwaitDiagnostic("Left " + TEST_CHANNEL));
+    };
+    ASSERT_TRUE(bot.UseSnapshot(TEST_SNAPSHOT_PATH));
+    bot.InitiateLogIn("token", {TEST_CHANNEL}, TEST_NICKNAME);
+    EXPECT_TRUE(connection->AwaitChatSent(1));
+    EXPECT_FALSE(firstQuestion.empty());
+    connection->Deliver(MembershipMessage("JOIN"));
+    EXPECT_TRUE(connection->AwaitChatSent(2));
+    bot.InitiateLogOut();
+    const auto deadline = std::chrono::steady_clock::now() + TEST_TIMEOUT;
+    while (!bot.AwaitLogOut()) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    }
+    std::ifstream snapshotFile(TEST_SNAPSHOT_PATH, std::ios::binary);
+    ASSERT_TRUE(snapshotFile.is_open());
+    std::ostringstream snapshot;
+    snapshot << snapshotFile.rdbuf();
+    EXPECT_EQ(
+        std::string::npos,
+        snapshot.str().find(
+            " " + std::to_string(firstQuestion.length()) + ":" + firstQuestion + " "
+        )
+    ) << snapshot.str();
+}
+
+TEST_F(MathBot2001Tests, SnapshotWithCorruptStringLengthRejected) {
+    {
+        std::ofstream snapshotFile(TEST_SNAPSHOT_PATH, std::ios::binary);
+        snapshotFile
+            << "MathBot2001 snapshot 4\n"
+            << std::mt19937() << "\n"
+            << "1\n"
+            << "18446744073709551615:" << TEST_CHANNEL << " 0 0: \n";
+    }
+    EXPECT_FALSE(bot.UseSnapshot(TEST_SNAPSHOT_PATH));
+}
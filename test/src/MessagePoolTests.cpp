@@ -0,0 +1,56 @@
+/**
+ * @file MessagePoolTests.cpp
+ *
+ * This module contains the unit tests of the PooledMessage structure
+ * and the MessagePool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <MessagePool.hpp>
+#include <string>
+#include <Twitch/Messaging.hpp>
+
+TEST(MessagePoolTests, AssignTakesContentAndId) {
+    MessagePool pool(1);
+    const auto message = pool.Acquire();
+    ASSERT_FALSE(message == nullptr);
+    Twitch::Messaging::MessageInfo messageInfo;
+    messageInfo.user = "Alice";
+    messageInfo.channel = "SomeChannel";
+    messageInfo.tags.id = "1234";
+    messageInfo.messageContent = "42";
+    ASSERT_TRUE(message->Assign(std::move(messageInfo), 1.5));
+    EXPECT_EQ("Alice", std::string(message->nickname, message->nicknameLength));
+    EXPECT_EQ("somechannel", std::string(message->channel, message->channelLength));
+    EXPECT_EQ("1234", message->msgId);
+    EXPECT_EQ("42", message->content);
+    EXPECT_EQ(1.5, message->receivedTime);
+    pool.Release(message);
+}
+
+TEST(MessagePoolTests, AssignRejectsLongNames) {
+    MessagePool pool(1);
+    const auto message = pool.Acquire();
+    ASSERT_FALSE(message == nullptr);
+    Twitch::Messaging::MessageInfo messageInfo;
+    messageInfo.user = std::string(PooledMessage::MAX_NAME_LENGTH + 1, 'a');
+    messageInfo.channel = "channel";
+    EXPECT_FALSE(message->Assign(std::move(messageInfo), 0.0));
+    pool.Release(message);
+}
+
+TEST(MessagePoolTests, PoolRunsOutAndRefills) {
+    MessagePool pool(2);
+    const auto first = pool.Acquire();
+    const auto second = pool.Acquire();
+    ASSERT_FALSE(first == nullptr);
+    ASSERT_FALSE(second == nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(pool.Acquire() == nullptr);
+    pool.Release(first);
+    EXPECT_EQ(first, pool.Acquire());
+    pool.Release(first);
+    pool.Release(second);
+}
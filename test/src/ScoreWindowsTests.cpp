@@ -0,0 +1,120 @@
+/**
+ * @file ScoreWindowsTests.cpp
+ *
+ * This module contains the unit tests of the ScoreWindows class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <ScoreWindows.hpp>
+#include <sstream>
+#include <StringInterner.hpp>
+
+namespace {
+
+    /**
+     * This is the number of seconds in an hour.
+     */
+    constexpr double HOUR = 3600.0;
+
+    /**
+     * This is the number of seconds in a day.
+     */
+    constexpr double DAY = 24 * HOUR;
+
+    /**
+     * This is the start of a season, used as the time at which
+     * the tests begin.
+     */
+    constexpr double START = 28 * DAY * 1000;
+
+}
+
+TEST(ScoreWindowsTests, TopOrderedByPointsThenNicknameId) {
+    ScoreWindows windows;
+    windows.AddPoints(0, 5, START);
+    windows.AddPoints(1, 7, START);
+    windows.AddPoints(2, 5, START);
+    windows.AddPoints(3, -2, START);
+    const auto top = windows.GetTop(ScoreWindow::Day, 3, START);
+    ASSERT_EQ(3, top.size());
+    EXPECT_EQ(1, top[0].nicknameId);
+    EXPECT_EQ(7, top[0].points);
+    EXPECT_EQ(0, top[1].nicknameId);
+    EXPECT_EQ(5, top[1].points);
+    EXPECT_EQ(2, top[2].nicknameId);
+    EXPECT_EQ(5, top[2].points);
+}
+
+TEST(ScoreWindowsTests, PointsFallOutOfEachWindow) {
+    ScoreWindows windows;
+    windows.AddPoints(0, 5, START);
+    windows.AddPoints(1, 3, START + 2 * DAY);
+    auto top = windows.GetTop(ScoreWindow::Day, 10, START + 2 * DAY);
+    ASSERT_EQ(1, top.size());
+    EXPECT_EQ(1, top[0].nicknameId);
+    top = windows.GetTop(ScoreWindow::Week, 10, START + 2 * DAY);
+    ASSERT_EQ(2, top.size());
+    EXPECT_EQ(0, top[0].nicknameId);
+    top = windows.GetTop(ScoreWindow::Week, 10, START + 8 * DAY);
+    ASSERT_EQ(1, top.size());
+    EXPECT_EQ(1, top[0].nicknameId);
+    top = windows.GetTop(ScoreWindow::Season, 10, START + 8 * DAY);
+    ASSERT_EQ(2, top.size());
+    top = windows.GetTop(ScoreWindow::Season, 10, START + 28 * DAY);
+    EXPECT_TRUE(top.empty());
+}
+
+TEST(ScoreWindowsTests, ContestantsDroppedOnceInNoWindow) {
+    ScoreWindows windows;
+    for (size_t nicknameId = 0; nicknameId < 100; ++nicknameId) {
+        windows.AddPoints(nicknameId, 1, START);
+    }
+    EXPECT_EQ(100, windows.CountContestants());
+
+    // After a week the contestants are only in the season.
+    windows.AddPoints(100, 1, START + 8 * DAY);
+    EXPECT_EQ(101, windows.CountContestants());
+
+    // Once the season is over, only those whose points changed
+    // within the last week are kept.
+    windows.AddPoints(101, 1, START + 28 * DAY);
+    EXPECT_EQ(1, windows.CountContestants());
+
+    // Once that season is over too, no one is kept.
+    (void)windows.GetTop(ScoreWindow::Day, 10, START + 56 * DAY);
+    EXPECT_EQ(0, windows.CountContestants());
+}
+
+TEST(ScoreWindowsTests, StateRoundTrip) {
+    StringInterner nicknames;
+    const auto alice = nicknames.Intern("alice");
+    const auto bob = nicknames.Intern("bob");
+    ScoreWindows windows;
+    windows.AddPoints(alice, 4, START);
+    windows.AddPoints(bob, 6, START + 3 * DAY);
+    windows.AddPoints(alice, 1, START + 3 * DAY + HOUR);
+    std::stringstream state;
+    windows.WriteState(state, nicknames);
+
+    // Read the state back with different nickname IDs.
+    StringInterner restoredNicknames;
+    (void)restoredNicknames.Intern("carol");
+    ScoreWindows restored;
+    ASSERT_TRUE(restored.ReadState(state, restoredNicknames));
+    const auto now = START + 3 * DAY + 2 * HOUR;
+    for (const auto window: {ScoreWindow::Day, ScoreWindow::Week, ScoreWindow::Season}) {
+        const auto expected = windows.GetTop(window, 10, now);
+        const auto actual = restored.GetTop(window, 10, now);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(
+                nicknames.GetString(expected[i].nicknameId),
+                restoredNicknames.GetString(actual[i].nicknameId)
+            );
+            EXPECT_EQ(expected[i].points, actual[i].points);
+        }
+    }
+    EXPECT_EQ(windows.CountContestants(), restored.CountContestants());
+}
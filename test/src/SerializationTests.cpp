@@ -0,0 +1,87 @@
+/**
+ * @file SerializationTests.cpp
+ *
+ * This module contains the unit tests of the functions shared by
+ * the modules which write values to files and read them back.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <Serialization.hpp>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+TEST(SerializationTests, SnapshotStringRoundTrip) {
+    const std::vector< std::string > values{
+        "",
+        "hello",
+        "with spaces and a\nnewline",
+        "12:34",
+    };
+    std::ostringstream output;
+    for (const auto& value: values) {
+        WriteSnapshotString(output, value);
+        output << ' ';
+    }
+    std::istringstream input(output.str());
+    for (const auto& expected: values) {
+        std::string actual;
+        ASSERT_TRUE(ReadSnapshotString(input >> std::ws, actual));
+        EXPECT_EQ(expected, actual);
+    }
+}
+
+TEST(SerializationTests, SnapshotStringTruncated) {
+    std::istringstream input("10:hello");
+    std::string value;
+    EXPECT_FALSE(ReadSnapshotString(input, value));
+}
+
+TEST(SerializationTests, SnapshotStringLengthTooLong) {
+    std::istringstream input(
+        std::to_string(MAX_STRING_LENGTH + 1) + ":hello"
+    );
+    std::string value;
+    EXPECT_FALSE(ReadSnapshotString(input, value));
+    std::istringstream hugeInput("18446744073709551615:hello");
+    EXPECT_FALSE(ReadSnapshotString(hugeInput, value));
+}
+
+TEST(SerializationTests, VarintAndZigZagRoundTrip) {
+    const std::vector< int64_t > values{
+        0, 1, -1, 63, -64, 64, 1000000, -1000000,
+        std::numeric_limits< int64_t >::max(),
+        std::numeric_limits< int64_t >::min(),
+    };
+    std::vector< uint8_t > buffer;
+    for (const auto value: values) {
+        AppendVarint(buffer, ZigZagEncode(value));
+    }
+    auto file = tmpfile();
+    ASSERT_FALSE(file == nullptr);
+    (void)fwrite(buffer.data(), 1, buffer.size(), file);
+    rewind(file);
+    for (const auto expected: values) {
+        uint64_t actual;
+        ASSERT_TRUE(ReadVarint(file, actual));
+        EXPECT_EQ(expected, ZigZagDecode(actual));
+    }
+    (void)fclose(file);
+}
+
+TEST(SerializationTests, StringLengthTooLong) {
+    std::vector< uint8_t > buffer;
+    AppendVarint(buffer, MAX_STRING_LENGTH + 1);
+    auto file = tmpfile();
+    ASSERT_FALSE(file == nullptr);
+    (void)fwrite(buffer.data(), 1, buffer.size(), file);
+    rewind(file);
+    std::string value;
+    EXPECT_FALSE(ReadString(file, value));
+    (void)fclose(file);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file TranscriptTests.cpp
+ *
+ * This module contains the unit tests of the TranscriptRecorder
+ * and TranscriptReader classes.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <Transcript.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the path of the transcript file used by the tests.
+     */
+    const std::string TEST_TRANSCRIPT_PATH = "TranscriptTests.bin";
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct TranscriptTests
+    : public ::testing::Test
+{
+    // ::testing::Test
+
+    virtual void SetUp() {
+        (void)remove(TEST_TRANSCRIPT_PATH.c_str());
+    }
+
+    virtual void TearDown() {
+        (void)remove(TEST_TRANSCRIPT_PATH.c_str());
+    }
+};
+
+TEST_F(TranscriptTests, RecordAndReadBack) {
+    std::vector< TranscriptEntry > entries(3);
+    entries[0].time = 1000.5;
+    entries[0].nickname = "alice";
+    entries[0].channel = "#chan";
+    entries[0].msgId = "1";
+    entries[0].content = "42";
+    entries[1].time = 1001.25;
+    entries[1].nickname = "bob";
+    entries[1].channel = "#chan";
+    entries[1].msgId = "2";
+    entries[1].content = "";
+    entries[2].time = 1000.0;
+    entries[2].nickname = "alice";
+    entries[2].channel = "#other";
+    entries[2].msgId = "3";
+    entries[2].content = "hello, world";
+    TranscriptRecorder recorder;
+    ASSERT_TRUE(recorder.Open(TEST_TRANSCRIPT_PATH));
+    for (const auto& entry: entries) {
+        ASSERT_TRUE(
+            recorder.Record(
+                entry.time,
+                entry.nickname,
+                entry.channel,
+                entry.msgId,
+                entry.content
+            )
+        );
+    }
+    ASSERT_TRUE(recorder.Close());
+    TranscriptReader reader;
+    ASSERT_TRUE(reader.Open(TEST_TRANSCRIPT_PATH));
+    for (const auto& expected: entries) {
+        TranscriptEntry actual;
+        ASSERT_TRUE(reader.Next(actual));
+        EXPECT_EQ(expected.time, actual.time);
+        EXPECT_EQ(expected.nickname, actual.nickname);
+        EXPECT_EQ(expected.channel, actual.channel);
+        EXPECT_EQ(expected.msgId, actual.msgId);
+        EXPECT_EQ(expected.content, actual.content);
+    }
+    TranscriptEntry extra;
+    EXPECT_FALSE(reader.Next(extra));
+}
+
+TEST_F(TranscriptTests, ReadBackAcrossSegments) {
+    // Record across several hours, in two sessions, so that the
+    // transcript has several segments, each with its own dictionaries.
+    constexpr size_t numSessions = 2;
+    constexpr size_t numMessagesPerSession = 1000;
+    for (size_t session = 0; session < numSessions; ++session) {
+        TranscriptRecorder recorder;
+        ASSERT_TRUE(recorder.Open(TEST_TRANSCRIPT_PATH));
+        for (size_t i = 0; i < numMessagesPerSession; ++i) {
+            const auto n = session * numMessagesPerSession + i;
+            ASSERT_TRUE(
+                recorder.Record(
+                    (double)n * 60.0,
+                    "user" + std::to_string(n % 7),
+                    "#chan" + std::to_string(n % 3),
+                    std::to_string(n),
+                    "message " + std::to_string(n)
+                )
+            );
+        }
+        ASSERT_TRUE(recorder.Close());
+    }
+    TranscriptReader reader;
+    ASSERT_TRUE(reader.Open(TEST_TRANSCRIPT_PATH));
+    for (size_t n = 0; n < numSessions * numMessagesPerSession; ++n) {
+        TranscriptEntry entry;
+        ASSERT_TRUE(reader.Next(entry)) << n;
+        EXPECT_EQ((double)n * 60.0, entry.time);
+        EXPECT_EQ("user" + std::to_string(n % 7), entry.nickname);
+        EXPECT_EQ("#chan" + std::to_string(n % 3), entry.channel);
+        EXPECT_EQ(std::to_string(n), entry.msgId);
+        EXPECT_EQ("message " + std::to_string(n), entry.content);
+    }
+    TranscriptEntry extra;
+    EXPECT_FALSE(reader.Next(extra));
+}
+
+TEST_F(TranscriptTests, TruncatedTranscriptEndsCleanly) {
+    TranscriptRecorder recorder;
+    ASSERT_TRUE(recorder.Open(TEST_TRANSCRIPT_PATH));
+    ASSERT_TRUE(recorder.Record(1.0, "alice", "#chan", "1", "first"));
+    ASSERT_TRUE(recorder.Record(2.0, "alice", "#chan", "2", "second"));
+    ASSERT_TRUE(recorder.Close());
+    auto file = fopen(TEST_TRANSCRIPT_PATH.c_str(), "rb");
+    ASSERT_FALSE(file == nullptr);
+    std::vector< char > contents(4096);
+    contents.resize(fread(contents.data(), 1, contents.size(), file));
+    (void)fclose(file);
+    file = fopen(TEST_TRANSCRIPT_PATH.c_str(), "wb");
+    ASSERT_FALSE(file == nullptr);
+    (void)fwrite(contents.data(), 1, contents.size() - 3, file);
+    (void)fclose(file);
+    TranscriptReader reader;
+    ASSERT_TRUE(reader.Open(TEST_TRANSCRIPT_PATH));
+    TranscriptEntry entry;
+    ASSERT_TRUE(reader.Next(entry));
+    EXPECT_EQ("first", entry.content);
+    EXPECT_FALSE(reader.Next(entry));
+}
+
+#ifdef __linux__
+TEST_F(TranscriptTests, WriteFailureReported) {
+    TranscriptRecorder recorder;
+    ASSERT_TRUE(recorder.Open("/dev/full"));
+    (void)recorder.Record(1.0, "alice", "#chan", "1", "42");
+    EXPECT_FALSE(recorder.Close());
+}
+#endif /* __linux__ */